@@ -0,0 +1,75 @@
+#include "bench_common.hpp"
+
+#include <cstdio>
+
+/*
+ * bench_asset_memory.cpp
+ *
+ * Heap used per asset at 100k assets, before and after interning.
+ * "Before" is the asset record as it was without a StringTable: every
+ * asset owning its own copy of each string, as a JSON parse produces
+ * them.  "After" is the current Asset after AssetLibrary::internAsset(),
+ * including the Library's StringTable.  Both hold the same assets.
+ */
+
+namespace {
+
+const int kCount = 100000;
+
+// Asset as it was before interning
+struct PlainAsset {
+    QString id;
+    QString name;
+    QString file;
+    QStringList tags;
+    QString theme;
+};
+
+// A copy with its own string data, like a freshly parsed one
+QString ownCopy(const QString &text)
+{
+    return text.isNull() ? QString() : QString(text.constData(), text.size());
+}
+
+QVector<PlainAsset> plainCopy(const QVector<Asset> &list)
+{
+    QVector<PlainAsset> plain;
+    plain.reserve(list.size());
+    for (const Asset &asset : list) {
+        PlainAsset copy;
+        copy.id = ownCopy(asset.id);
+        copy.name = ownCopy(asset.name);
+        copy.file = ownCopy(asset.file);
+        copy.theme = ownCopy(asset.theme);
+        for (const QString &tag : asset.tags)
+            copy.tags << ownCopy(tag);
+        plain.push_back(copy);
+    }
+    return plain;
+}
+
+void printRow(const char *label, qint64 bytes)
+{
+    std::printf("%-22s  %10.1f  %12.0f\n", label, bytes / (1024.0 * 1024.0), double(bytes) / kCount);
+}
+
+} // namespace
+
+int main()
+{
+    const qint64 start = heapBytesInUse();
+    Library lib = makeSyntheticLibrary(kCount);
+    const qint64 interned = heapBytesInUse() - start;
+
+    const qint64 beforePlain = heapBytesInUse();
+    QVector<PlainAsset> backgrounds = plainCopy(lib.backgrounds);
+    QVector<PlainAsset> characters = plainCopy(lib.characters);
+    const qint64 plain = heapBytesInUse() - beforePlain;
+
+    std::printf("%d assets, %d interned strings\n", kCount, lib.strings.size());
+    std::printf("%-22s  %10s  %12s\n", "", "heap (MB)", "bytes/asset");
+    printRow("before (own strings)", plain);
+    printRow("after (interned)", interned);
+    std::printf("sizeof: before %d, after %d bytes\n", int(sizeof(PlainAsset)), int(sizeof(Asset)));
+    return backgrounds.size() + characters.size() == kCount ? 0 : 1;
+}
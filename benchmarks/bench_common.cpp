@@ -0,0 +1,116 @@
+#include "bench_common.hpp"
+
+#include <QRandomGenerator>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__linux__)
+#include <cstdio>
+#include <malloc.h>
+#include <unistd.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#endif
+
+namespace {
+
+const char *const kAdjectives[] = {
+    "Ancient", "Quiet", "Burning", "Frozen", "Hidden", "Golden", "Misty", "Ruined",
+    "Sunny", "Stormy", "Silent", "Crimson", "Endless", "Forgotten", "Shattered", "Verdant",
+};
+
+const char *const kNouns[] = {
+    "Forest", "Desert", "Harbor", "Castle", "Tavern", "Cavern", "Market", "Temple",
+    "Valley", "Bridge", "Library", "Camp", "Swamp", "Tower", "Village", "Shrine",
+};
+
+const char *const kThemes[] = {
+    "Desert", "Forest", "Mountain", "City", "Dungeon", "Coast", "Sky", "Underdark",
+};
+
+const char *const kTags[] = {
+    "night", "day", "rain", "snow", "fog", "interior", "exterior", "battle",
+    "calm", "boss", "npc", "ally", "villain", "merchant", "noble", "beast",
+    "undead", "elf", "dwarf", "human", "orc", "magic", "tech", "ruins",
+};
+
+template<typename T, size_t N>
+const char *pick(QRandomGenerator &random, const T (&words)[N])
+{
+    return words[random.bounded(int(N))];
+}
+
+Asset makeAsset(QRandomGenerator &random, const QString &kind, int index, bool withTheme)
+{
+    Asset asset;
+    asset.id = QString("%1-%2").arg(kind).arg(index);
+    asset.name = QString("%1 %2 %3").arg(QLatin1String(pick(random, kAdjectives)),
+                                         QLatin1String(pick(random, kNouns)),
+                                         QString::number(index));
+    asset.file = QString("C:/Assets/%1/%2.png").arg(kind).arg(index);
+    if (withTheme)
+        asset.theme = QLatin1String(pick(random, kThemes));
+    const int tagCount = random.bounded(5);
+    for (int i = 0; i < tagCount; ++i) {
+        const QString tag = QLatin1String(pick(random, kTags));
+        if (!asset.tags.contains(tag))
+            asset.tags.push_back(tag);
+    }
+    return asset;
+}
+
+} // namespace
+
+Library makeSyntheticLibrary(int count)
+{
+    QRandomGenerator random(quint32(count));
+    Library lib;
+    lib.backgrounds.reserve(count - count / 2);
+    lib.characters.reserve(count / 2);
+    for (int i = 0; i < count; ++i) {
+        if (i % 2 == 0) {
+            Asset asset = makeAsset(random, "bg", i, true);
+            AssetLibrary::internAsset(lib, asset);
+            lib.backgrounds.push_back(asset);
+        } else {
+            Asset asset = makeAsset(random, "char", i, false);
+            AssetLibrary::internAsset(lib, asset);
+            lib.characters.push_back(asset);
+        }
+    }
+    return lib;
+}
+
+qint64 residentMemoryBytes()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return qint64(counters.WorkingSetSize);
+    return 0;
+#elif defined(__linux__)
+    FILE *statm = std::fopen("/proc/self/statm", "r");
+    if (!statm)
+        return 0;
+    long size = 0;
+    long resident = 0;
+    const int read = std::fscanf(statm, "%ld %ld", &size, &resident);
+    std::fclose(statm);
+    return read == 2 ? qint64(resident) * sysconf(_SC_PAGESIZE) : 0;
+#else
+    return 0;
+#endif
+}
+
+qint64 heapBytesInUse()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    const struct mallinfo2 info = mallinfo2();
+    return qint64(info.uordblks + info.hblkhd);
+#elif defined(__APPLE__)
+    return qint64(mstats().bytes_used);
+#else
+    return residentMemoryBytes();
+#endif
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QVector>
+#include <algorithm>
+
+#include "asset_library.hpp"
+
+/*
+ * bench_common.hpp
+ *
+ * Helpers shared by the benchmark executables: a median timer, a
+ * deterministic synthetic library and the process's heap and resident
+ * memory.
+ * Numbers are printed as plain tables on stdout; the benchmarks are
+ * meant to be run by hand on a Release build and compared before and
+ * after a change, not to gate CI.
+ */
+
+/** Median wall time of runs calls to fn, in microseconds. */
+template<typename Fn>
+double medianMicros(int runs, Fn &&fn)
+{
+    QVector<double> samples;
+    samples.reserve(runs);
+    QElapsedTimer timer;
+    for (int i = 0; i < runs; ++i) {
+        timer.start();
+        fn();
+        samples.push_back(timer.nsecsElapsed() / 1000.0);
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples.at(samples.size() / 2);
+}
+
+/**
+ * A library of count assets, half backgrounds and half characters,
+ * with names, themes and tags drawn from a fixed vocabulary.  The same
+ * count always gives the same library.  Every asset is interned.
+ */
+Library makeSyntheticLibrary(int count);
+
+/** Resident memory of this process in bytes, or 0 where unsupported. */
+qint64 residentMemoryBytes();
+
+/** Bytes currently allocated from the heap, from the allocator's own
+ * statistics where it has them (glibc, macOS) and the resident memory
+ * otherwise.  Unlike resident memory it drops again when freed. */
+qint64 heapBytesInUse();
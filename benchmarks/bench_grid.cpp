@@ -0,0 +1,80 @@
+#include "bench_common.hpp"
+#include "grid_image.hpp"
+
+#include <QPainter>
+#include <QPen>
+#include <cstdio>
+
+/*
+ * bench_grid.cpp
+ *
+ * The row‑fill grid rasteriser against painting every line with
+ * QPainter, as the grid image used to be made, at 1080p, 1440p, 4K and
+ * 8K.  Both images are compared pixel by pixel (the indexed one
+ * converted to ARGB32) and the benchmark fails if they differ.
+ */
+
+namespace {
+
+struct Canvas {
+    const char *name;
+    int width;
+    int height;
+};
+
+const Canvas kCanvases[] = {
+    {"1080p", 1920, 1080},
+    {"1440p", 2560, 1440},
+    {"4K", 3840, 2160},
+    {"8K", 7680, 4320},
+};
+
+const int kGridSize = 50;
+const int kRuns = 15;
+
+// The previous implementation: one painter pass per line over the canvas
+QImage paintGridImage(int width, int height, int gridSize, const QColor &color)
+{
+    QImage image(width, height, QImage::Format_ARGB32);
+    image.fill(Qt::transparent);
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing, false);
+    QPen pen(color);
+    pen.setWidth(1);
+    painter.setPen(pen);
+    for (int x = 0; x <= width; x += gridSize)
+        painter.drawLine(x, 0, x, height);
+    for (int y = 0; y <= height; y += gridSize)
+        painter.drawLine(0, y, width, y);
+    painter.end();
+    return image;
+}
+
+} // namespace
+
+int main()
+{
+    const QColor colors[] = {QColor(255, 255, 255, 255), QColor(255, 255, 255, 128)};
+
+    std::printf("%-6s  %-7s  %14s  %14s  %8s\n", "canvas", "opacity", "QPainter (ms)", "row fill (ms)", "speedup");
+    for (const Canvas &canvas : kCanvases) {
+        for (const QColor &color : colors) {
+            QImage painted;
+            QImage filled;
+            const double painterUs = medianMicros(kRuns, [&]() {
+                painted = paintGridImage(canvas.width, canvas.height, kGridSize, color);
+            });
+            const double fillUs = medianMicros(kRuns, [&]() {
+                filled = renderGridImageIndexed(canvas.width, canvas.height, kGridSize, color);
+            });
+            if (filled.convertToFormat(QImage::Format_ARGB32) != painted) {
+                std::fprintf(stderr, "%s grid at alpha %d differs from the QPainter image\n",
+                             canvas.name, color.alpha());
+                return 1;
+            }
+            std::printf("%-6s  %-7d  %14.2f  %14.2f  %7.1fx\n", canvas.name, color.alpha(),
+                        painterUs / 1000.0, fillUs / 1000.0, fillUs > 0 ? painterUs / fillUs : 0.0);
+        }
+    }
+    return 0;
+}
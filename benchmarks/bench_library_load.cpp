@@ -0,0 +1,130 @@
+#include "bench_common.hpp"
+#include "library_snapshot.hpp"
+
+#include <QCoreApplication>
+#include <QFileInfo>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <cstdio>
+
+/*
+ * bench_library_load.cpp
+ *
+ * Cold load of the library from JSON and from the binary snapshot at
+ * 10k and 100k assets.  Every load runs in a fresh child process, so it
+ * starts with no Qt or library state warmed up, and the child reports
+ * its load time and how much its resident memory grew.  The file itself
+ * may still be in the OS page cache.  A JSON load also writes the
+ * snapshot for the next start, so that cost is part of its time.
+ *
+ * Qt's test mode keeps the snapshots out of the real config directory.
+ */
+
+namespace {
+
+const int kCounts[] = {10000, 100000};
+const int kRuns = 5;
+
+struct Sample {
+    double loadMs = 0;
+    double residentMb = 0;
+};
+
+// Child side: load once and print "microseconds resident-bytes assets"
+int runLoad(const QString &path)
+{
+    const qint64 before = residentMemoryBytes();
+    QElapsedTimer timer;
+    timer.start();
+    const Library lib = AssetLibrary::loadFromFile(path);
+    const qint64 elapsedUs = timer.nsecsElapsed() / 1000;
+    const qint64 grown = residentMemoryBytes() - before;
+    std::printf("%lld %lld %d\n", static_cast<long long>(elapsedUs), static_cast<long long>(grown),
+                int(lib.backgrounds.size() + lib.characters.size()));
+    return 0;
+}
+
+bool loadInChild(const QString &path, int expected, Sample *sample)
+{
+    QProcess child;
+    child.start(QCoreApplication::applicationFilePath(), {"--load", path});
+    if (!child.waitForFinished(-1) || child.exitCode() != 0)
+        return false;
+    const QList<QByteArray> fields = child.readAllStandardOutput().trimmed().split(' ');
+    if (fields.size() != 3 || fields.at(2).toInt() != expected)
+        return false;
+    sample->loadMs = fields.at(0).toLongLong() / 1000.0;
+    sample->residentMb = fields.at(1).toLongLong() / (1024.0 * 1024.0);
+    return true;
+}
+
+Sample median(QVector<Sample> samples)
+{
+    Sample result;
+    std::sort(samples.begin(), samples.end(), [](const Sample &a, const Sample &b) { return a.loadMs < b.loadMs; });
+    result.loadMs = samples.at(samples.size() / 2).loadMs;
+    std::sort(samples.begin(), samples.end(), [](const Sample &a, const Sample &b) { return a.residentMb < b.residentMb; });
+    result.residentMb = samples.at(samples.size() / 2).residentMb;
+    return result;
+}
+
+void printRow(int count, const char *mode, qint64 fileBytes, const Sample &sample)
+{
+    std::printf("%8d  %-9s  %10.1f  %10.1f  %13.1f\n", count, mode,
+                fileBytes / (1024.0 * 1024.0), sample.loadMs, sample.residentMb);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("velutan-bench");
+    QStandardPaths::setTestModeEnabled(true);
+
+    if (argc == 3 && qstrcmp(argv[1], "--load") == 0)
+        return runLoad(QString::fromLocal8Bit(argv[2]));
+
+    QTemporaryDir dir;
+    if (!dir.isValid())
+        return 1;
+    if (residentMemoryBytes() == 0)
+        std::printf("Resident memory is not measured on this platform.\n");
+    std::printf("%8s  %-9s  %10s  %10s  %13s\n", "assets", "source", "file (MB)", "load (ms)", "resident (MB)");
+
+    for (int count : kCounts) {
+        const QString path = dir.filePath(QString("library-%1.json").arg(count));
+        const QString snapshot = LibrarySnapshot::pathFor(path);
+        if (!AssetLibrary::saveToFile(path, makeSyntheticLibrary(count))) {
+            std::fprintf(stderr, "Could not write %s\n", qPrintable(path));
+            return 1;
+        }
+
+        // Without a snapshot every run parses the JSON and writes one
+        QVector<Sample> json;
+        for (int run = 0; run < kRuns; ++run) {
+            QFile::remove(snapshot);
+            Sample sample;
+            if (!loadInChild(path, count, &sample)) {
+                std::fprintf(stderr, "JSON load of %d assets failed\n", count);
+                return 1;
+            }
+            json.push_back(sample);
+        }
+        printRow(count, "JSON", QFileInfo(path).size(), median(json));
+
+        QVector<Sample> mapped;
+        for (int run = 0; run < kRuns; ++run) {
+            Sample sample;
+            if (!loadInChild(path, count, &sample)) {
+                std::fprintf(stderr, "Snapshot load of %d assets failed\n", count);
+                return 1;
+            }
+            mapped.push_back(sample);
+        }
+        printRow(count, "snapshot", QFileInfo(snapshot).size(), median(mapped));
+        QFile::remove(snapshot);
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include "bench_common.hpp"
+#include "search_index.hpp"
+
+#include <cstdio>
+
+/*
+ * bench_search.cpp
+ *
+ * SearchIndex against the linear AssetLibrary::search scan at 1k, 10k
+ * and 100k assets.  For every size it reports the time to build the
+ * index and, per query, the median time of both searches including
+ * collecting the matching assets the way the dock does.  Both must
+ * return the same number of matches or the benchmark fails.
+ */
+
+namespace {
+
+const int kCounts[] = {1000, 10000, 100000};
+
+// Short queries fall back to a scan inside the index, the rest use grams
+const char *const kQueries[] = {"", "fo", "forest", "night", "quiet tav", "shrine 4", "xyzzy"};
+
+} // namespace
+
+int main()
+{
+    std::printf("%8s  %-10s  %8s  %12s  %12s  %8s\n",
+                "assets", "query", "matches", "linear (us)", "index (us)", "speedup");
+
+    for (int count : kCounts) {
+        const Library lib = makeSyntheticLibrary(count);
+        const QVector<Asset> &list = lib.backgrounds;
+        const int runs = count >= 100000 ? 7 : 31;
+
+        SearchIndex index;
+        const double buildUs = medianMicros(5, [&]() { index.build(list, lib.strings); });
+        std::printf("%8d  index build over %d backgrounds: %.0f us\n", count, int(list.size()), buildUs);
+
+        for (const char *query : kQueries) {
+            const QString q = QString::fromLatin1(query);
+            QVector<Asset> linear;
+            QVector<Asset> indexed;
+            const double linearUs = medianMicros(runs, [&]() {
+                linear = AssetLibrary::search(list, q);
+            });
+            const double indexUs = medianMicros(runs, [&]() {
+                const QVector<int> rows = index.search(list, lib.strings, q);
+                indexed.clear();
+                indexed.reserve(rows.size());
+                for (int row : rows)
+                    indexed.push_back(list.at(row));
+            });
+            if (linear.size() != indexed.size()) {
+                std::fprintf(stderr, "Mismatch for \"%s\" at %d assets: linear %d, index %d\n",
+                             query, count, int(linear.size()), int(indexed.size()));
+                return 1;
+            }
+            std::printf("%8d  %-10s  %8d  %12.1f  %12.1f  %7.1fx\n", count,
+                        qPrintable(QString("\"%1\"").arg(q)), int(indexed.size()),
+                        linearUs, indexUs, indexUs > 0 ? linearUs / indexUs : 0.0);
+        }
+    }
+    return 0;
+}
@@ -1,4 +1,7 @@
 #include "asset_library.hpp"
+#include "library_snapshot.hpp"
+#include "json_reader.hpp"
+#include "atomic_file.hpp"
 
 #include <QFile>
 #include <QJsonArray>
@@ -6,47 +9,131 @@
 #include <QJsonObject>
 #include <QDebug>
 
+namespace {
+
+// Read a string member the way QJsonValue::toString() would: anything
+// that is not a string reads as empty
+bool readText(JsonReader &reader, QString *out)
+{
+    if (reader.atString())
+        return reader.readString(out);
+    out->clear();
+    return reader.skipValue();
+}
+
+bool readAsset(JsonReader &reader, Asset *asset)
+{
+    if (!reader.beginObject())
+        return false;
+    QByteArray key;
+    while (reader.nextMember(&key)) {
+        bool ok;
+        if (key == "id") {
+            ok = readText(reader, &asset->id);
+        } else if (key == "name") {
+            ok = readText(reader, &asset->name);
+        } else if (key == "file") {
+            ok = readText(reader, &asset->file);
+        } else if (key == "theme") {
+            ok = readText(reader, &asset->theme);
+        } else if (key == "tags" && !reader.atArray()) {
+            // Like QJsonValue::toArray(): anything else means no tags
+            ok = reader.skipValue();
+        } else if (key == "tags") {
+            ok = reader.beginArray();
+            QString tag;
+            while (ok && reader.nextElement()) {
+                ok = readText(reader, &tag);
+                asset->tags << tag;
+            }
+        } else {
+            ok = reader.skipValue();
+        }
+        if (!ok || reader.failed())
+            return false;
+    }
+    return !reader.failed();
+}
+
+} // namespace
+
 Library AssetLibrary::loadFromFile(const QString &path)
 {
     Library lib;
+    // A snapshot made from the current JSON loads without any parsing
+    if (LibrarySnapshot::load(path, &lib))
+        return lib;
     QFile file(path);
     if (!file.open(QIODevice::ReadOnly)) {
         qWarning() << "[Velutan] Could not open library file" << path;
+        // A file that exists but cannot be read must not be saved over
+        lib.complete = !file.exists();
         return lib;
     }
-    QByteArray data = file.readAll();
-    file.close();
-    QJsonParseError err;
-    QJsonDocument doc = QJsonDocument::fromJson(data, &err);
-    if (err.error != QJsonParseError::NoError) {
-        qWarning() << "[Velutan] Failed to parse library JSON:" << err.errorString();
-        return lib;
+    // Parse straight from the mapped file into Asset records; no
+    // QJsonDocument and, when mapping works, no copy of the file either
+    QByteArray buffer;
+    qint64 size = file.size();
+    const char *data = reinterpret_cast<const char *>(file.map(0, size));
+    if (!data) {
+        buffer = file.readAll();
+        data = buffer.constData();
+        size = buffer.size();
     }
-    QJsonObject root = doc.object();
-    auto parseArray = [](const QJsonArray &arr) {
-        QVector<Asset> list;
-        list.reserve(arr.size());
-        for (const QJsonValue &val : arr) {
-            QJsonObject obj = val.toObject();
+    JsonReader reader(data, size);
+
+    int skipped = 0;
+    auto parseArray = [&](QVector<Asset> *list) {
+        // Like QJsonValue::toArray(): anything else is an empty list
+        if (!reader.atArray())
+            return reader.skipValue();
+        if (!reader.beginArray())
+            return false;
+        while (reader.nextElement()) {
+            const qint64 start = reader.position();
             Asset a;
-            a.id = obj.value("id").toString();
-            a.name = obj.value("name").toString();
-            a.file = obj.value("file").toString();
-            a.theme = obj.value("theme").toString();  // Read theme field
-            QJsonArray tagsArr = obj.value("tags").toArray();
-            for (const QJsonValue &tagVal : tagsArr) {
-                a.tags << tagVal.toString();
+            if (readAsset(reader, &a)) {
+                list->push_back(a);
+                continue;
             }
-            list.push_back(a);
+            // Step over just this entry and carry on with the next
+            ++skipped;
+            reader.seek(start);
+            reader.clearError();
+            if (!reader.skipValue())
+                return false;
         }
-        return list;
+        return !reader.failed();
     };
-    if (root.contains("backgrounds")) {
-        lib.backgrounds = parseArray(root.value("backgrounds").toArray());
-    }
-    if (root.contains("characters")) {
-        lib.characters = parseArray(root.value("characters").toArray());
+
+    bool complete = reader.beginObject();
+    QByteArray key;
+    while (complete && reader.nextMember(&key)) {
+        if (key == "backgrounds")
+            complete = parseArray(&lib.backgrounds);
+        else if (key == "characters")
+            complete = parseArray(&lib.characters);
+        else
+            complete = reader.skipValue();
     }
+    complete = complete && !reader.failed();
+    lib.complete = complete;
+    if (skipped > 0)
+        qWarning() << "[Velutan] Skipped" << skipped << "malformed entries in" << path;
+    if (!complete)
+        qWarning() << "[Velutan] Library JSON is malformed near offset" << reader.position()
+                   << "- keeping the" << lib.backgrounds.size() + lib.characters.size()
+                   << "entries read before it";
+
+    for (Asset &a : lib.backgrounds)
+        internAsset(lib, a);
+    for (Asset &a : lib.characters)
+        internAsset(lib, a);
+    // Next time, load the snapshot instead.  Failing to write it only
+    // costs the next load a parse.  A truncated file is left to be
+    // parsed (and reported) again.
+    if (complete)
+        LibrarySnapshot::save(path, lib);
     return lib;
 }
 
@@ -55,35 +142,51 @@ bool AssetLibrary::saveToFile(const QString &path, const Library &lib)
     QJsonObject root;
     auto buildArray = [](const QVector<Asset> &list) {
         QJsonArray arr;
-        for (const Asset &a : list) {
-            QJsonObject obj;
-            obj.insert("id", a.id);
-            obj.insert("name", a.name);
-            obj.insert("file", a.file);
-            if (!a.theme.isEmpty()) {
-                obj.insert("theme", a.theme);  // Write theme field if set
-            }
-            QJsonArray tagsArr;
-            for (const QString &t : a.tags)
-                tagsArr.append(t);
-            obj.insert("tags", tagsArr);
-            arr.append(obj);
-        }
+        for (const Asset &a : list)
+            arr.append(assetToJson(a));
         return arr;
     };
     root.insert("backgrounds", buildArray(lib.backgrounds));
     root.insert("characters", buildArray(lib.characters));
     QJsonDocument doc(root);
-    QFile file(path);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    // Replaced atomically, so a crash mid-save leaves the old library
+    if (!writeFileAtomically(path, doc.toJson(QJsonDocument::Indented))) {
         qWarning() << "[Velutan] Could not write library file" << path;
         return false;
     }
-    file.write(doc.toJson(QJsonDocument::Indented));
-    file.close();
+    LibrarySnapshot::save(path, lib);
     return true;
 }
 
+QJsonObject AssetLibrary::assetToJson(const Asset &asset)
+{
+    QJsonObject obj;
+    obj.insert("id", asset.id);
+    obj.insert("name", asset.name);
+    obj.insert("file", asset.file);
+    if (!asset.theme.isEmpty()) {
+        obj.insert("theme", asset.theme);  // Write theme field if set
+    }
+    QJsonArray tagsArr;
+    for (const QString &t : asset.tags)
+        tagsArr.append(t);
+    obj.insert("tags", tagsArr);
+    return obj;
+}
+
+Asset AssetLibrary::assetFromJson(const QJsonObject &obj)
+{
+    Asset a;
+    a.id = obj.value("id").toString();
+    a.name = obj.value("name").toString();
+    a.file = obj.value("file").toString();
+    a.theme = obj.value("theme").toString();
+    const QJsonArray tagsArr = obj.value("tags").toArray();
+    for (const QJsonValue &tagVal : tagsArr)
+        a.tags << tagVal.toString();
+    return a;
+}
+
 QVector<Asset> AssetLibrary::search(const QVector<Asset> &list, const QString &query)
 {
     QVector<Asset> result;
@@ -114,4 +217,40 @@ QVector<Asset> AssetLibrary::search(const QVector<Asset> &list, const QString &q
         }
     }
     return result;
-}
\ No newline at end of file
+}
+
+void AssetLibrary::internAsset(Library &lib, Asset &asset)
+{
+    asset.foldedName = asset.name.toLower();
+    if (asset.theme.isEmpty()) {
+        asset.themeId = -1;
+    } else {
+        asset.themeId = lib.strings.intern(asset.theme);
+        asset.theme = lib.strings.text(asset.themeId);  // Share table data
+    }
+    for (QString &tag : asset.tags)
+        tag = lib.strings.text(lib.strings.intern(tag));  // Share table data
+}
+
+int StringTable::intern(const QString &text)
+{
+    auto it = m_ids.constFind(text);
+    if (it != m_ids.constEnd())
+        return it.value();
+    int id = m_text.size();
+    m_text.push_back(text);
+    m_folded.push_back(text.toLower());
+    m_ids.insert(text, id);
+    return id;
+}
+
+int StringTable::find(const QString &text) const
+{
+    return m_ids.value(text, -1);
+}
+
+QString StringTable::folded(const QString &text) const
+{
+    auto it = m_ids.constFind(text);
+    return it != m_ids.constEnd() ? m_folded.at(it.value()) : text.toLower();
+}
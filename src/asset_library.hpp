@@ -1,5 +1,8 @@
 #pragma once
 
+#include <QHash>
+#include <QJsonObject>
+#include <QSet>
 #include <QString>
 #include <QStringList>
 #include <QVector>
@@ -11,27 +14,74 @@
  * assets as loaded from a JSON catalogue.  The AssetLibrary helper
  * class provides static functions for loading and saving the library as
  * well as performing case‑insensitive searches through lists of assets.
+ *
+ * Themes and tags repeat across many assets, so a Library interns them
+ * into a shared StringTable: an asset's theme and tag QStrings share
+ * the table's data instead of each holding a copy, and its theme is
+ * also referred to by a small integer id.  Lower‑cased forms are
+ * computed once at load so that searching and filtering never have to
+ * fold or allocate per asset.  Tags keep no ids of their own; a
+ * per‑asset id list would cost an allocation for every tagged asset.
  */
 
+class StringTable
+{
+public:
+    /** Return the id of the given text, adding it if necessary. */
+    int intern(const QString &text);
+
+    /** Return the id of the given text or -1 if it was never interned. */
+    int find(const QString &text) const;
+
+    /** Original text for an id. */
+    const QString &text(int id) const { return m_text.at(id); }
+
+    /** Lower‑cased text for an id. */
+    const QString &folded(int id) const { return m_folded.at(id); }
+
+    /** Lower‑cased form of an interned text, or of text itself if it
+     * was never interned. */
+    QString folded(const QString &text) const;
+
+    int size() const { return m_text.size(); }
+
+private:
+    QVector<QString> m_text;
+    QVector<QString> m_folded;
+    QHash<QString, int> m_ids;
+};
+
 struct Asset {
     QString id;
     QString name;
     QString file;
     QStringList tags;
     QString theme;  // For backgrounds: Desert, Forest, Mountain, etc.
+
+    // Derived at load time by AssetLibrary::internAsset()
+    QString foldedName;  // name.toLower(); shares data when already lower case
+    int themeId = -1;    // Library::strings id of theme, -1 when empty
 };
 
 struct Library {
     QVector<Asset> backgrounds;
     QVector<Asset> characters;
+    StringTable strings;  // Interned themes and tags
+    QSet<QString> shards;  // Shards loaded so far (sharded layout only, see library_shards.hpp)
+    bool complete = true;  // False if a file was only partly read; must not be saved in full
 };
 
 class AssetLibrary
 {
 public:
     /**
-     * Load an asset library from a JSON file.  If the file cannot be
-     * opened or parsed the returned library will be empty.
+     * Load an asset library from a JSON file.  The file is read with a
+     * pull parser directly into Asset records; malformed entries are
+     * skipped one by one, and if the file itself is malformed (or
+     * exists but cannot be read) the entries read before the error are
+     * kept and the library is marked incomplete (Library::complete).
+     * Uses the binary snapshot next to the file when it is up to date,
+     * and regenerates it otherwise (see LibrarySnapshot).
      *
      * @param path Path to the JSON file
      * @return Parsed library
@@ -39,7 +89,8 @@ public:
     static Library loadFromFile(const QString &path);
 
     /**
-     * Save an asset library back to disk.  Returns true on success.
+     * Save an asset library back to disk, refreshing its binary
+     * snapshot.  Returns true on success.
      *
      * @param path Path to write the JSON file
      * @param lib  Library to save
@@ -47,6 +98,13 @@ public:
      */
     static bool saveToFile(const QString &path, const Library &lib);
 
+    /**
+     * Convert a single asset to and from the JSON object stored in
+     * library.json.  assetFromJson() does not intern the asset.
+     */
+    static QJsonObject assetToJson(const Asset &asset);
+    static Asset assetFromJson(const QJsonObject &obj);
+
     /**
      * Search through a list of assets.  The search is case‑insensitive and
      * matches if the query is a substring of the asset name or any tag.
@@ -56,4 +114,14 @@ public:
      * @return Matching assets
      */
     static QVector<Asset> search(const QVector<Asset> &list, const QString &query);
+
+    /**
+     * Intern an asset's theme and tags into the library's string table
+     * and compute its folded name.  Must be called whenever an asset is
+     * added or its name, theme or tags change.
+     *
+     * @param lib   Library owning the string table
+     * @param asset Asset to update in place
+     */
+    static void internAsset(Library &lib, Asset &asset);
 };
@@ -0,0 +1,113 @@
+#include "atomic_file.hpp"
+
+#include <QFileInfo>
+#include <QTemporaryFile>
+#include <QDebug>
+#include <atomic>
+#include <filesystem>
+#include <system_error>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+std::atomic<int> g_defaultDurability{int(Durability::Synced)};
+
+std::filesystem::path toFsPath(const QString &path)
+{
+#ifdef _WIN32
+    return std::filesystem::path(path.toStdWString());
+#else
+    return std::filesystem::path(QFile::encodeName(path).toStdString());
+#endif
+}
+
+bool syncDirectory(const QString &dir)
+{
+#ifdef _WIN32
+    // NTFS journals the rename itself; there is no directory handle to sync
+    Q_UNUSED(dir);
+    return true;
+#else
+    const int fd = ::open(QFile::encodeName(dir).constData(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    const bool ok = ::fsync(fd) == 0;
+    ::close(fd);
+    return ok;
+#endif
+}
+
+} // namespace
+
+Durability defaultDurability()
+{
+    return Durability(g_defaultDurability.load());
+}
+
+void setDefaultDurability(Durability durability)
+{
+    g_defaultDurability.store(int(durability));
+}
+
+Durability durabilityFromName(const QString &name)
+{
+    if (name.compare(QLatin1String("atomic"), Qt::CaseInsensitive) == 0)
+        return Durability::Atomic;
+    if (name.compare(QLatin1String("durable"), Qt::CaseInsensitive) == 0)
+        return Durability::Durable;
+    return Durability::Synced;
+}
+
+bool syncFile(QFile &file)
+{
+    if (!file.flush())
+        return false;
+#ifdef _WIN32
+    return ::_commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+bool writeFileAtomically(const QString &path, const QByteArray &data, Durability durability)
+{
+    // The temporary file must be on the same file system as the target
+    // for the rename to be atomic, so it goes in the same directory.  It
+    // is removed again by QTemporaryFile on any failure below.
+    const QFileInfo info(path);
+    QTemporaryFile temp(info.absolutePath() + "/." + info.fileName() + ".XXXXXX");
+    if (!temp.open()) {
+        qWarning() << "[Velutan] Could not create temporary file for" << path;
+        return false;
+    }
+    if (info.exists())
+        temp.setPermissions(info.permissions());
+    else
+        temp.setPermissions(QFile::ReadOwner | QFile::WriteOwner | QFile::ReadGroup | QFile::ReadOther);
+
+    if (temp.write(data) != data.size()
+            || (durability != Durability::Atomic && !syncFile(temp))) {
+        qWarning() << "[Velutan] Could not write" << path << ":" << temp.errorString();
+        return false;
+    }
+    // Windows cannot rename a file that is still open
+    temp.close();
+
+    std::error_code error;
+    std::filesystem::rename(toFsPath(temp.fileName()), toFsPath(path), error);
+    if (error) {
+        qWarning() << "[Velutan] Could not replace" << path << ":" << QString::fromStdString(error.message());
+        return false;
+    }
+    temp.setAutoRemove(false);
+
+    if (durability == Durability::Durable && !syncDirectory(info.absolutePath()))
+        qWarning() << "[Velutan] Could not sync directory of" << path;
+    return true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+/*
+ * atomic_file.hpp
+ *
+ * Crash‑safe replacement of whole files.  The new contents are written
+ * to a temporary file in the same directory and renamed over the
+ * target, so a reader (or the next start after a crash) always sees
+ * either the old file or the new one, never a truncated mix.
+ *
+ * How hard the data is pushed to disk is a Durability level:
+ *
+ *   Atomic   rename only; survives OBS crashing but not a power loss
+ *   Synced   fsync the new file before the rename (the default)
+ *   Durable  also fsync the directory after the rename, so the rename
+ *            itself survives a power loss (no‑op on Windows)
+ *
+ * Derived caches such as the library snapshot are written Atomic;
+ * user data follows defaultDurability(), which the dock sets from the
+ * "writeDurability" config value.
+ */
+
+enum class Durability { Atomic, Synced, Durable };
+
+/** Durability used for user data unless a caller asks otherwise. */
+Durability defaultDurability();
+void setDefaultDurability(Durability durability);
+
+/** Parse "atomic", "synced" or "durable"; anything else is Synced. */
+Durability durabilityFromName(const QString &name);
+
+/**
+ * Replace the file at path with data.  Returns true on success; on
+ * failure the previous file is left untouched.
+ */
+bool writeFileAtomically(const QString &path, const QByteArray &data,
+                         Durability durability = defaultDurability());
+
+/** Flush an open file's data to disk (fsync).  Returns true on success. */
+bool syncFile(QFile &file);
@@ -0,0 +1,162 @@
+#include "background_pool.hpp"
+#include "obs_integration.hpp"
+
+#include <QImageReader>
+#include <QSet>
+#include <algorithm>
+
+namespace {
+
+// Candidates looked at per preload, as a multiple of the pool size;
+// each costs an image header read the first time
+const int kCandidateFactor = 4;
+
+} // namespace
+
+BackgroundPool::BackgroundPool(ObsIntegration *obs, QObject *parent)
+    : QObject(parent), m_obs(obs)
+{
+    m_createTimer.setSingleShot(true);
+    m_createTimer.setInterval(0);
+    connect(&m_createTimer, &QTimer::timeout, this, &BackgroundPool::createNext);
+}
+
+void BackgroundPool::setLimits(int maxSources, qint64 budgetBytes)
+{
+    m_maxSources = std::max(0, maxSources);
+    m_budgetBytes = std::max<qint64>(0, budgetBytes);
+}
+
+bool BackgroundPool::show(const QString &sceneName, const QString &targetName, const QString &assetId,
+                          const QString &file)
+{
+    const QString prefix = prefixFor(sceneName, targetName);
+    const QString name = prefix + assetId;
+    const QHash<QString, SceneItemState> items = m_obs->sceneSnapshot(sceneName);
+    auto pooled = items.constFind(name);
+    // A stale copy is left hidden for preload() to replace
+    if (pooled == items.constEnd() || pooled->file != file)
+        return false;
+
+    // Swap in one scene update, so no frame is rendered without a background
+    SceneBatch batch;
+    for (auto it = items.constBegin(); it != items.constEnd(); ++it) {
+        if (it.key() != name && it.key().startsWith(prefix) && it->visible)
+            batch.setVisible(it.key(), false);
+    }
+    batch.setVisible(sceneName + "_" + targetName, false);
+    batch.setVisible(name, true);
+    return m_obs->apply(sceneName, batch);
+}
+
+void BackgroundPool::showTarget(const QString &sceneName, const QString &targetName)
+{
+    const QString prefix = prefixFor(sceneName, targetName);
+    const QHash<QString, SceneItemState> items = m_obs->sceneSnapshot(sceneName);
+    SceneBatch batch;
+    for (auto it = items.constBegin(); it != items.constEnd(); ++it) {
+        if (it.key().startsWith(prefix) && it->visible)
+            batch.setVisible(it.key(), false);
+    }
+    batch.setVisible(sceneName + "_" + targetName, true);
+    m_obs->apply(sceneName, batch);
+}
+
+void BackgroundPool::preload(const QString &sceneName, const QString &targetName,
+                             const QVector<Candidate> &candidates, bool autoStretch)
+{
+    const QString prefix = prefixFor(sceneName, targetName);
+
+    // One pool at a time, so the limits hold across scenes
+    const auto pools = m_pools;
+    for (auto it = pools.constBegin(); it != pools.constEnd(); ++it) {
+        if (it.key() != prefix)
+            release(it->first, it->second);
+    }
+    if (enabled())
+        m_pools.insert(prefix, qMakePair(sceneName, targetName));
+    else
+        m_pools.remove(prefix);
+
+    const QHash<QString, SceneItemState> items = m_obs->sceneSnapshot(sceneName);
+
+    // Pick the most likely candidates that fit, skipping any too large
+    // for what is left of the budget
+    QSet<QString> keep;
+    QVector<Pending> wanted;
+    if (enabled()) {
+        qint64 used = 0;
+        const int considered = std::min<int>(candidates.size(), m_maxSources * kCandidateFactor);
+        for (int i = 0; i < considered && keep.size() < m_maxSources; ++i) {
+            const Candidate &candidate = candidates.at(i);
+            const qint64 size = decodedSize(candidate.file);
+            if (size < 0 || used + size > m_budgetBytes)
+                continue;
+            used += size;
+            const QString name = prefix + candidate.assetId;
+            keep.insert(name);
+            auto it = items.constFind(name);
+            if (it == items.constEnd()) {
+                wanted.push_back(Pending{sceneName, name, candidate.file, autoStretch});
+            } else if (it->file != candidate.file && !it->visible) {
+                // The asset's file was changed since it was pooled
+                m_obs->removeSource(name);
+                wanted.push_back(Pending{sceneName, name, candidate.file, autoStretch});
+            }
+        }
+    }
+
+    // Evict what is no longer wanted, except the background on screen
+    for (auto it = items.constBegin(); it != items.constEnd(); ++it) {
+        if (it.key().startsWith(prefix) && !keep.contains(it.key()) && !it->visible)
+            m_obs->removeSource(it.key());
+    }
+    m_pending.erase(std::remove_if(m_pending.begin(), m_pending.end(), [&](const Pending &pending) {
+        return pending.sourceName.startsWith(prefix);
+    }), m_pending.end());
+    m_pending += wanted;
+    if (!m_pending.isEmpty() && !m_createTimer.isActive())
+        m_createTimer.start();
+}
+
+void BackgroundPool::release(const QString &sceneName, const QString &targetName)
+{
+    const QString prefix = prefixFor(sceneName, targetName);
+    m_pools.remove(prefix);
+    const QHash<QString, SceneItemState> items = m_obs->sceneSnapshot(sceneName);
+    for (auto it = items.constBegin(); it != items.constEnd(); ++it) {
+        if (it.key().startsWith(prefix) && !it->visible)
+            m_obs->removeSource(it.key());
+    }
+    m_pending.erase(std::remove_if(m_pending.begin(), m_pending.end(), [&](const Pending &pending) {
+        return pending.sourceName.startsWith(prefix);
+    }), m_pending.end());
+}
+
+void BackgroundPool::createNext()
+{
+    if (m_pending.isEmpty())
+        return;
+    const Pending pending = m_pending.takeFirst();
+    m_obs->addPreloadedImage(pending.sceneName, pending.sourceName, pending.file, pending.autoStretch);
+    // One per pass, so the decoding does not stall the dock
+    if (!m_pending.isEmpty())
+        m_createTimer.start();
+}
+
+QString BackgroundPool::prefixFor(const QString &sceneName, const QString &targetName)
+{
+    return sceneName + "_" + targetName + "_Pool_";
+}
+
+qint64 BackgroundPool::decodedSize(const QString &file)
+{
+    auto it = m_sizes.constFind(file);
+    if (it != m_sizes.constEnd())
+        return it.value();
+    // Only the header is read
+    const QSize size = QImageReader(file).size();
+    const qint64 bytes = size.isValid() ? qint64(size.width()) * size.height() * 4 : -1;
+    m_sizes.insert(file, bytes);
+    return bytes;
+}
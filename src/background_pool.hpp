@@ -0,0 +1,104 @@
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+
+/*
+ * background_pool.hpp
+ *
+ * Optional preloading of backgrounds.  Setting a background normally
+ * changes the file of the scene's background image source, so OBS has
+ * to read and decode the image at that moment; with large images that
+ * shows as a hitch and a blank frame or two.  The pool instead keeps
+ * the backgrounds most likely to be picked next as hidden, already
+ * decoded image sources at the bottom of the scene, next to the
+ * background target.  Switching to a pooled background is then only a
+ * visibility flip.
+ *
+ * Pooled sources are named <scene>_<target>_Pool_<asset id> and are
+ * found again from the scene itself, so the pool needs no state of its
+ * own across restarts.  The pool is bounded by a number of sources and
+ * by a budget for their decoded size (width × height × 4 bytes).  New
+ * sources are created one per event loop pass, as image_source decodes
+ * its file on creation.
+ *
+ * The limits are global: only the selected scene keeps preloaded
+ * backgrounds.  Preloading for one scene releases the pools of every
+ * other scene, and the dock releases the previous scene's pool when the
+ * selection changes.  A scene keeps only the pooled background it is
+ * showing, which costs no more than a background target showing the
+ * same image.
+ */
+
+class ObsIntegration;
+
+class BackgroundPool : public QObject
+{
+    Q_OBJECT
+public:
+    struct Candidate {
+        QString assetId;
+        QString file;
+    };
+
+    explicit BackgroundPool(ObsIntegration *obs, QObject *parent = nullptr);
+
+    /** Keep at most maxSources backgrounds of at most budgetBytes in
+     * total.  maxSources 0 disables the pool. */
+    void setLimits(int maxSources, qint64 budgetBytes);
+    bool enabled() const { return m_maxSources > 0; }
+
+    /**
+     * Show the pooled copy of an asset in place of the background
+     * target, hiding the target and any other pooled background.
+     * Returns false, changing nothing, if the asset is not pooled or
+     * its pooled copy was loaded from a file other than file (the asset
+     * was edited since).
+     */
+    bool show(const QString &sceneName, const QString &targetName, const QString &assetId,
+              const QString &file);
+
+    /** Hide every pooled background and show the target again. */
+    void showTarget(const QString &sceneName, const QString &targetName);
+
+    /**
+     * Make the scene's pool hold the first candidates that fit the
+     * limits, most likely first.  Pooled backgrounds that are no longer
+     * candidates are removed unless they are the one showing.  With the
+     * pool disabled every pooled background is removed.  The pools of
+     * all other scenes are released first.
+     */
+    void preload(const QString &sceneName, const QString &targetName,
+                 const QVector<Candidate> &candidates, bool autoStretch);
+
+    /** Remove the scene's pooled backgrounds except the one showing,
+     * and cancel any still to be created. */
+    void release(const QString &sceneName, const QString &targetName);
+
+private slots:
+    void createNext();
+
+private:
+    struct Pending {
+        QString sceneName;
+        QString sourceName;
+        QString file;
+        bool autoStretch = false;
+    };
+
+    static QString prefixFor(const QString &sceneName, const QString &targetName);
+    qint64 decodedSize(const QString &file);
+
+    ObsIntegration *m_obs;
+    int m_maxSources = 0;
+    qint64 m_budgetBytes = 0;
+    QVector<Pending> m_pending;        // Sources still to be created
+    QTimer m_createTimer;
+    QHash<QString, qint64> m_sizes;    // Decoded size by file
+    QHash<QString, QPair<QString, QString>> m_pools;  // Prefix → (scene, target) preloaded this session
+};
@@ -0,0 +1,52 @@
+#include "config_store.hpp"
+
+namespace {
+
+// Longest a changed preference waits before it reaches disk
+const int kFlushIntervalMs = 1000;
+
+} // namespace
+
+ConfigStore::ConfigStore(QObject *parent)
+    : QObject(parent)
+{
+    m_pool.setMaxThreadCount(1);
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(kFlushIntervalMs);
+    connect(&m_timer, &QTimer::timeout, this, &ConfigStore::writePending);
+}
+
+ConfigStore::~ConfigStore()
+{
+    flush();
+}
+
+void ConfigStore::update(const PersistenceConfig &config)
+{
+    m_pending = config;
+    m_dirty = true;
+    // Leave a running timer alone so that a steady stream of updates
+    // still flushes once per interval rather than being postponed
+    if (!m_timer.isActive())
+        m_timer.start();
+}
+
+void ConfigStore::flush()
+{
+    m_timer.stop();
+    writePending();
+    m_pool.waitForDone();
+}
+
+void ConfigStore::writePending()
+{
+    if (!m_dirty)
+        return;
+    m_dirty = false;
+    // PersistenceConfig is made of implicitly shared Qt types, so the
+    // copy handed to the worker is cheap and independent of later updates
+    const PersistenceConfig config = m_pending;
+    m_pool.start([config]() {
+        saveConfig(config);
+    });
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QObject>
+#include <QThreadPool>
+#include <QTimer>
+
+#include "persistence.hpp"
+
+/*
+ * config_store.hpp
+ *
+ * Debounced writer for the user's PersistenceConfig.  The dock calls
+ * update() whenever a preference changes, which only records the new
+ * value; the file is rewritten at most once per flush interval, on a
+ * background thread, with whatever value is current by then.  Typing
+ * in the search box therefore costs no disk I/O on the GUI thread, and
+ * a burst of changes costs a single write.
+ *
+ * Writes go through saveConfig(), which replaces the file atomically.
+ * flush() writes any pending change and waits for it; the destructor
+ * calls it so nothing is lost on shutdown.
+ */
+
+class ConfigStore : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ConfigStore(QObject *parent = nullptr);
+    ~ConfigStore();
+
+    /** Record config as the value to persist and schedule a write. */
+    void update(const PersistenceConfig &config);
+
+    /** Write any pending change now and wait for all writes to finish. */
+    void flush();
+
+private slots:
+    void writePending();
+
+private:
+    QThreadPool m_pool;  // A single thread, so writes land in order
+    QTimer m_timer;
+    PersistenceConfig m_pending;
+    bool m_dirty = false;
+};
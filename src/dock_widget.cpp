@@ -1,6 +1,9 @@
 #include "dock_widget.hpp"
 #include "setup_dialog.hpp"
 #include "theme_constants.hpp"
+#include "library_journal.hpp"
+#include "library_shards.hpp"
+#include "atomic_file.hpp"
 
 #include "ui/HeaderBar.hpp"
 #include "ui/AssetList.hpp"
@@ -8,6 +11,7 @@
 #include "ui/Toast.hpp"
 #include "ui/PinnedSourcesDialog.hpp"
 #include "ui/GridSettingsDialog.hpp"
+#include "ui/ThumbnailCache.hpp"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -25,6 +29,7 @@
 #include <QLabel>
 #include <QCompleter>
 #include <QSet>
+#include <QSignalBlocker>
 #include <algorithm>
 #include <cstring>
 
@@ -33,8 +38,23 @@ extern "C" {
 #include <obs-frontend-api.h>
 }
 
+namespace {
+
+// Backgrounds remembered for preloading
+const int kMaxRecentBackgrounds = 16;
+
+// Relative asset paths live in the plugin's data directory
+QString assetFilePath(const Asset &asset)
+{
+    if (QDir::isAbsolutePath(asset.file))
+        return asset.file;
+    return QCoreApplication::applicationDirPath() + "/data/" + asset.file;
+}
+
+} // namespace
+
 VelutanDockWidget::VelutanDockWidget(QWidget *parent)
-    : QWidget(parent)
+    : QWidget(parent), m_bgPool(&m_obs)
 {
     blog(LOG_INFO, "[Velutan] VelutanDockWidget constructor started");
     
@@ -59,6 +79,7 @@ VelutanDockWidget::VelutanDockWidget(QWidget *parent)
     connect(m_headerBar, &HeaderBar::pinnedSourcesSettingsRequested, this, &VelutanDockWidget::onPinnedSourcesSettings);
     connect(m_headerBar, &HeaderBar::gridToggled, this, &VelutanDockWidget::onGridToggled);
     connect(m_headerBar, &HeaderBar::gridSettingsRequested, this, &VelutanDockWidget::onGridSettings);
+    connect(m_headerBar, &HeaderBar::snapAllRequested, this, &VelutanDockWidget::onSnapAll);
 
     // Tutorial card appears conditionally
     m_tutorial = new TutorialCard(this);
@@ -247,12 +268,30 @@ VelutanDockWidget::VelutanDockWidget(QWidget *parent)
             m_bgTagFilter->setVisible(false);
             m_charTagFilter->setVisible(true);
         }
+        
+        // A sharded library may not have loaded this tab's assets yet
+        if (ShardedLibrary::enabled())
+            refreshLists();
     });
 
     // Asset actions propagate through this dock widget
     connect(m_bgList, &AssetList::assetActionTriggered, this, &VelutanDockWidget::onAssetAction);
     connect(m_charList, &AssetList::assetActionTriggered, this, &VelutanDockWidget::onAssetAction);
 
+    // Library writes happen in the background; only failures are worth
+    // interrupting the user for
+    connect(&m_librarySaver, &LibrarySaver::finished, this, [this](bool ok) {
+        if (!ok)
+            m_toast->showMessage("⚠ Could not save library");
+    });
+
+    // Keep the active markers in step with changes made directly in OBS.
+    // The mirror already coalesces bursts into one notification.
+    connect(&m_obs, &ObsIntegration::sceneChanged, this, [this](const QString &sceneName) {
+        if (sceneName == m_config.selectedScene)
+            refreshLists();
+    });
+
     // Toast for transient notifications
     m_toast = new Toast(this);
     // Place the toast above the tabs; layout order ensures it stays at
@@ -278,7 +317,11 @@ VelutanDockWidget::VelutanDockWidget(QWidget *parent)
     m_tutorial->setVisibleByConfig(m_config.dismissedTutorial);
     // Restore last search and tab
     m_searchEdit->setText(m_config.lastSearch);
-    m_tabs->setCurrentIndex(m_config.lastTabIndex);
+    {
+        // The lists are populated by the delayed initialization below
+        QSignalBlocker blocker(m_tabs);
+        m_tabs->setCurrentIndex(m_config.lastTabIndex);
+    }
     
     // Set initial filter visibility based on tab
     if (m_config.lastTabIndex == 0) {
@@ -312,20 +355,44 @@ VelutanDockWidget::VelutanDockWidget(QWidget *parent)
 
 VelutanDockWidget::~VelutanDockWidget()
 {
-    // Persist user preferences on destruction
+    // Persist user preferences and library changes on destruction and
+    // wait for the writes
     saveConfig();
+    m_configStore.flush();
+    m_librarySaver.flush();
+    LibraryJournal::instance().waitForCompaction();
+    
+    // Report thumbnail cache effectiveness so the budget can be tuned
+    ThumbnailCache::Stats stats = ThumbnailCache::instance().stats();
+    blog(LOG_INFO, "[Velutan] Thumbnail cache: %llu hits, %llu misses, %llu evictions, %d entries, %lld KB",
+         (unsigned long long)stats.hits, (unsigned long long)stats.misses,
+         (unsigned long long)stats.evictions, stats.entries, (long long)(stats.bytes / 1024));
+    // The pixmaps must go while the application still exists, not at
+    // static destruction after OBS has torn it down
+    ThumbnailCache::instance().clear();
 }
 
 void VelutanDockWidget::loadLibrary()
 {
     // Attempt to load the user library from the config directory.  If
     // none exists we fall back to the default library bundled with the
-    // plugin in the data folder.
-    QString userPath = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation)
-            + "/velutan-image-manager/library.json";
+    // plugin in the data folder.  Changes still queued for writing
+    // have to reach the disk first or the reload would drop them.
+    m_librarySaver.flush();
+    ShardedLibrary &shards = ShardedLibrary::instance();
+    shards.migrate();
+    if (ShardedLibrary::enabled() && shards.exists()) {
+        // Shards are loaded on demand by refreshLists()
+        m_library = Library();
+        rebuildSearchIndex();
+        return;
+    }
+    QString userPath = libraryFilePath();
     QFile userFile(userPath);
     if (userFile.exists()) {
         m_library = AssetLibrary::loadFromFile(userPath);
+        LibraryJournal::instance().replay(&m_library);
+        rebuildSearchIndex();
         return;
     }
     // Fallback: locate the default library relative to the module's
@@ -334,6 +401,80 @@ void VelutanDockWidget::loadLibrary()
     QString fallback = QCoreApplication::applicationDirPath()
             + "/data/velutan_library.json";
     m_library = AssetLibrary::loadFromFile(fallback);
+    rebuildSearchIndex();
+}
+
+void VelutanDockWidget::rebuildSearchIndex()
+{
+    // Build the search indexes once per load; edits and deletes keep
+    // them in step incrementally afterwards.
+    m_bgIndex.build(m_library.backgrounds, m_library.strings);
+    m_charIndex.build(m_library.characters, m_library.strings);
+}
+
+void VelutanDockWidget::loadVisibleShards()
+{
+    // With a sharded library only the shards the current tab and theme
+    // filter show are loaded; searching within a theme needs just that
+    // theme's shard, anything else needs every background shard.
+    if (!ShardedLibrary::enabled())
+        return;
+    ShardedLibrary &shards = ShardedLibrary::instance();
+    QStringList keys;
+    if (m_tabs->currentIndex() == 1) {
+        keys << ShardedLibrary::keyFor(true);
+    } else {
+        const QString theme = m_themeFilter->currentText();
+        if (theme != "🌍 All Themes" && !theme.isEmpty())
+            keys << ShardedLibrary::keyFor(false, theme);
+        else
+            keys = shards.backgroundKeys();
+    }
+    if (shards.load(&m_library, keys) > 0)
+        rebuildSearchIndex();
+}
+
+void VelutanDockWidget::preloadBackgrounds(const Asset &current)
+{
+    // Most likely next, in order: the current background (so switching
+    // back is instant), recently used ones, then the rest of its theme.
+    // With the pool disabled this clears out any pooled backgrounds.
+    QVector<BackgroundPool::Candidate> candidates;
+    QSet<QString> seen;
+    auto add = [&](const Asset &asset) {
+        if (!seen.contains(asset.id)) {
+            seen.insert(asset.id);
+            candidates.push_back(BackgroundPool::Candidate{asset.id, assetFilePath(asset)});
+        }
+    };
+    add(current);
+    
+    QHash<QString, int> recentRank;
+    for (int i = 0; i < m_config.recentBackgrounds.size(); ++i) {
+        recentRank.insert(m_config.recentBackgrounds.at(i), i);
+    }
+    QVector<const Asset *> recent(m_config.recentBackgrounds.size(), nullptr);
+    for (const Asset &bg : m_library.backgrounds) {
+        auto it = recentRank.constFind(bg.id);
+        if (it != recentRank.constEnd()) {
+            recent[it.value()] = &bg;
+        }
+    }
+    for (const Asset *bg : recent) {
+        if (bg) {
+            add(*bg);
+        }
+    }
+    if (!current.theme.isEmpty()) {
+        for (const Asset &bg : m_library.backgrounds) {
+            if (bg.theme == current.theme) {
+                add(bg);
+            }
+        }
+    }
+    
+    m_bgPool.preload(m_config.selectedScene, m_config.bgTargetName, candidates,
+                     m_config.autoStretchBackgrounds);
 }
 
 void VelutanDockWidget::loadConfig()
@@ -342,13 +483,18 @@ void VelutanDockWidget::loadConfig()
     // member function recursively.  The :: prefix forces lookup in
     // global namespace.
     m_config = ::loadConfig();
+    setDefaultDurability(durabilityFromName(m_config.writeDurability));
+    ShardedLibrary::setEnabled(m_config.shardedLibrary);
+    ThumbnailCache::instance().setBudget(qint64(m_config.thumbnailCacheMB) * 1024 * 1024);
+    m_bgPool.setLimits(m_config.backgroundPoolSize, qint64(m_config.backgroundPoolMB) * 1024 * 1024);
 }
 
 void VelutanDockWidget::saveConfig()
 {
-    // Write the current configuration via the free function.  Without
-    // the :: prefix this would recursively call the member function.
-    ::saveConfig(m_config);
+    // Hand the current configuration to the store, which writes it in
+    // the background at most once per interval.  Cheap enough to call
+    // on every keystroke.
+    m_configStore.update(m_config);
 }
 
 void VelutanDockWidget::updateSceneList()
@@ -416,53 +562,70 @@ void VelutanDockWidget::updateSceneList()
         m_headerBar->setSelectedScene(currentSceneName);
         blog(LOG_INFO, "[Velutan] Selected current scene: %s", currentSceneName.toUtf8().constData());
     }
+    
+    // Drop preloaded backgrounds an earlier session left in other scenes
+    for (const QString &scene : std::as_const(scenes)) {
+        if (scene != m_config.selectedScene)
+            m_bgPool.release(scene, m_config.bgTargetName);
+    }
 }
 
 void VelutanDockWidget::refreshLists()
 {
     try {
+        loadVisibleShards();
+        
         QString query = m_searchEdit->text().trimmed();
         QString selectedTheme = m_themeFilter->currentText();
         QString selectedBgTag = m_bgTagFilter->currentText();
         QString selectedCharTag = m_charTagFilter->currentText();
         
-        // Apply search filter first
-        QVector<Asset> bgMatches = AssetLibrary::search(m_library.backgrounds, query);
-        QVector<Asset> charMatches = AssetLibrary::search(m_library.characters, query);
+        // Apply search filter first.  The indexes return row numbers, and
+        // the theme and tag filters below narrow those rows by comparing
+        // interned ids and tags, so no asset is copied or case-folded
+        // until the final lists are built.
+        const StringTable &strings = m_library.strings;
+        QVector<int> bgRows = m_bgIndex.search(m_library.backgrounds, strings, query);
+        QVector<int> charRows = m_charIndex.search(m_library.characters, strings, query);
+        
+        auto keepRows = [](QVector<int> &rows, auto predicate) {
+            rows.erase(std::remove_if(rows.begin(), rows.end(),
+                                      [&](int row) { return !predicate(row); }),
+                       rows.end());
+        };
         
         // Apply theme filter (backgrounds only)
         if (selectedTheme != "🌍 All Themes" && !selectedTheme.isEmpty()) {
-            QVector<Asset> filteredBg;
-            for (const Asset &asset : bgMatches) {
-                if (asset.theme == selectedTheme) {
-                    filteredBg.append(asset);
-                }
-            }
-            bgMatches = filteredBg;
+            int themeId = strings.find(selectedTheme);
+            keepRows(bgRows, [&](int row) {
+                return themeId >= 0 && m_library.backgrounds.at(row).themeId == themeId;
+            });
         }
         
         // Apply background tag filter
         if (selectedBgTag != "🏷 All Tags" && !selectedBgTag.isEmpty()) {
-            QVector<Asset> filteredBg;
-            for (const Asset &asset : bgMatches) {
-                if (asset.tags.contains(selectedBgTag)) {
-                    filteredBg.append(asset);
-                }
-            }
-            bgMatches = filteredBg;
+            keepRows(bgRows, [&](int row) {
+                return m_library.backgrounds.at(row).tags.contains(selectedBgTag);
+            });
         }
         
         // Apply character tag filter
         if (selectedCharTag != "🏷 All Tags" && !selectedCharTag.isEmpty()) {
-            QVector<Asset> filteredChar;
-            for (const Asset &asset : charMatches) {
-                if (asset.tags.contains(selectedCharTag)) {
-                    filteredChar.append(asset);
-                }
-            }
-            charMatches = filteredChar;
+            keepRows(charRows, [&](int row) {
+                return m_library.characters.at(row).tags.contains(selectedCharTag);
+            });
         }
         
+        auto collect = [](const QVector<Asset> &list, const QVector<int> &rows) {
+            QVector<Asset> assets;
+            assets.reserve(rows.size());
+            for (int row : rows)
+                assets.push_back(list.at(row));
+            return assets;
+        };
+        QVector<Asset> bgMatches = collect(m_library.backgrounds, bgRows);
+        QVector<Asset> charMatches = collect(m_library.characters, charRows);
+        
         // Get active background for current scene
         QStringList activeBgList;
         if (m_config.activeBackgrounds.contains(m_config.selectedScene)) {
@@ -471,17 +634,16 @@ void VelutanDockWidget::refreshLists()
         m_bgList->setActiveAssets(activeBgList);
         
         // Detect which characters are currently active (visible) in the scene
-        // Use scene-specific source names
+        // Use scene-specific source names.  The scene is enumerated once
+        // and each character is then a hash lookup.
         QStringList activeCharacters;
         if (!m_config.selectedScene.isEmpty()) {
+            const QHash<QString, SceneItemState> sceneItems = m_obs.sceneSnapshot(m_config.selectedScene);
+            const QString sourcePrefix = m_config.selectedScene + "_" + m_config.overlayPrefix;
             for (const Asset &asset : charMatches) {
-                QString sourceName = m_config.selectedScene + "_" + m_config.overlayPrefix + asset.id;
-                try {
-                    if (m_obs.isVisible(m_config.selectedScene, sourceName)) {
-                        activeCharacters << asset.name;
-                    }
-                } catch (...) {
-                    // Skip this asset if checking visibility fails
+                auto it = sceneItems.constFind(sourcePrefix + asset.id);
+                if (it != sceneItems.constEnd() && it->visible) {
+                    activeCharacters << asset.name;
                 }
             }
         }
@@ -506,6 +668,9 @@ void VelutanDockWidget::onSearchChanged(const QString &text)
 
 void VelutanDockWidget::onSceneChanged(const QString &name)
 {
+    // Only the selected scene keeps preloaded backgrounds
+    if (name != m_config.selectedScene)
+        m_bgPool.release(m_config.selectedScene, m_config.bgTargetName);
     m_config.selectedScene = name;
     
     // Ensure the background source exists in the newly selected scene
@@ -591,19 +756,27 @@ void VelutanDockWidget::onAssetAction(const Asset &asset, const QString &action)
 {
     // Resolve the asset's file path.  If the path is relative then we
     // assume it lives in the plugin's data directory.
-    QString filePath = asset.file;
-    if (!QDir::isAbsolutePath(filePath)) {
-        filePath = QCoreApplication::applicationDirPath() + "/data/" + asset.file;
-    }
+    QString filePath = assetFilePath(asset);
     if (action == QLatin1String("set")) {
-        // Ensure background target exists in the current scene
-        m_obs.ensureBackgroundTarget(m_config.selectedScene, m_config.bgTargetName);
-        // Set as background (with auto-stretch if enabled)
-        m_obs.setBackground(m_config.selectedScene, m_config.bgTargetName, filePath, m_config.autoStretchBackgrounds);
+        // A preloaded copy is shown instantly; otherwise the background
+        // target loads the file
+        if (!m_bgPool.show(m_config.selectedScene, m_config.bgTargetName, asset.id, filePath)) {
+            // Ensure background target exists in the current scene
+            m_obs.ensureBackgroundTarget(m_config.selectedScene, m_config.bgTargetName);
+            // Set as background (with auto-stretch if enabled)
+            m_obs.setBackground(m_config.selectedScene, m_config.bgTargetName, filePath, m_config.autoStretchBackgrounds);
+            m_bgPool.showTarget(m_config.selectedScene, m_config.bgTargetName);
+        }
         
         // Track active background for this scene
         m_config.activeBackgrounds[m_config.selectedScene] = asset.id;
+        m_config.recentBackgrounds.removeAll(asset.id);
+        m_config.recentBackgrounds.prepend(asset.id);
+        while (m_config.recentBackgrounds.size() > kMaxRecentBackgrounds) {
+            m_config.recentBackgrounds.removeLast();
+        }
         saveConfig();
+        preloadBackgrounds(asset);
         
         // Refresh to update UI (active background moves to top, green styling)
         refreshLists();
@@ -613,43 +786,38 @@ void VelutanDockWidget::onAssetAction(const Asset &asset, const QString &action)
         // Scene-specific character source name
         QString srcName = m_config.selectedScene + "_" + m_config.overlayPrefix + asset.id;
         bool visible = m_obs.isVisible(m_config.selectedScene, srcName);
+        // Collect every change and apply them as one scene update
+        SceneBatch batch;
         if (!visible) {
-            m_obs.ensureCharacter(m_config.selectedScene, srcName, filePath);
+            m_obs.ensureCharacter(m_config.selectedScene, srcName, filePath, &batch);
             m_toast->showMessage("👤 " + asset.name + " added to scene");
         } else {
-            m_obs.toggleCharacter(m_config.selectedScene, srcName, false);
+            batch.setVisible(srcName, false);
             m_toast->showMessage("👁 " + asset.name + " hidden");
         }
         // Ensure pinned sources stay on top
-        m_obs.bringPinnedToFront(m_config.selectedScene, m_config.pinnedSources);
+        batch.keepOnTop(m_config.pinnedSources);
+        m_obs.apply(m_config.selectedScene, batch);
         // Refresh the list to update active status
         refreshLists();
     } else if (action == QLatin1String("front")) {
         // Scene-specific character source name
         QString srcName = m_config.selectedScene + "_" + m_config.overlayPrefix + asset.id;
-        m_obs.bringToFront(m_config.selectedScene, srcName);
-        // Ensure pinned sources stay on top
-        m_obs.bringPinnedToFront(m_config.selectedScene, m_config.pinnedSources);
+        // Raise it and keep pinned sources on top with a single reorder
+        SceneBatch batch;
+        batch.raise(srcName);
+        batch.keepOnTop(m_config.pinnedSources);
+        m_obs.apply(m_config.selectedScene, batch);
         m_toast->showMessage("⬆ " + asset.name + " brought to front");
     } else if (action == QLatin1String("remove")) {
         // Remove character from scene completely
         QString srcName = m_config.selectedScene + "_" + m_config.overlayPrefix + asset.id;
         
-        // Get the source and remove it from the scene
-        obs_source_t *source = obs_get_source_by_name(srcName.toUtf8().constData());
-        if (source) {
-            // Remove from scene
-            obs_scene_t *scene = obs_scene_from_source(obs_frontend_get_current_scene());
-            if (scene) {
-                obs_sceneitem_t *item = obs_scene_find_source(scene, srcName.toUtf8().constData());
-                if (item) {
-                    obs_sceneitem_remove(item);
-                }
-            }
-            obs_source_release(source);
+        // Remove its item from the selected scene; the source itself stays
+        if (m_obs.removeFromScene(m_config.selectedScene, srcName)) {
+            // Removing an item leaves the order of the rest, pinned
+            // sources included, as it was
             m_toast->showMessage("🗑 " + asset.name + " removed from scene");
-            // Ensure pinned sources stay on top
-            m_obs.bringPinnedToFront(m_config.selectedScene, m_config.pinnedSources);
             refreshLists();
         }
     } else if (action == QLatin1String("edit")) {
@@ -725,22 +893,33 @@ void VelutanDockWidget::onAssetAction(const Asset &asset, const QString &action)
             
             // Find and update the asset
             bool updated = false;
-            for (Asset &bg : m_library.backgrounds) {
+            Asset updatedAsset;
+            LibraryJournal::Category category = LibraryJournal::Category::Backgrounds;
+            for (int i = 0; i < m_library.backgrounds.size(); i++) {
+                Asset &bg = m_library.backgrounds[i];
                 if (bg.id == asset.id) {
                     bg.name = newName;
                     bg.tags = newTags;
                     if (themeCombo) {
                         bg.theme = themeCombo->currentText().trimmed();
                     }
+                    AssetLibrary::internAsset(m_library, bg);
+                    m_bgIndex.update(i, bg, m_library.strings);
+                    updatedAsset = bg;
                     updated = true;
                     break;
                 }
             }
             if (!updated) {
-                for (Asset &ch : m_library.characters) {
+                for (int i = 0; i < m_library.characters.size(); i++) {
+                    Asset &ch = m_library.characters[i];
                     if (ch.id == asset.id) {
                         ch.name = newName;
                         ch.tags = newTags;
+                        AssetLibrary::internAsset(m_library, ch);
+                        m_charIndex.update(i, ch, m_library.strings);
+                        updatedAsset = ch;
+                        category = LibraryJournal::Category::Characters;
                         updated = true;
                         break;
                     }
@@ -748,10 +927,8 @@ void VelutanDockWidget::onAssetAction(const Asset &asset, const QString &action)
             }
             
             if (updated) {
-                // Save library
-                QString userPath = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation)
-                        + "/velutan-image-manager/library.json";
-                AssetLibrary::saveToFile(userPath, m_library);
+                // Save library; only the edited asset is written
+                m_librarySaver.record(LibraryJournal::Op::Update, category, updatedAsset, m_library);
                 
                 // Update filters and refresh lists
                 updateFilterLists();
@@ -772,9 +949,11 @@ void VelutanDockWidget::onAssetAction(const Asset &asset, const QString &action)
         if (msgBox.exec() == QMessageBox::Yes) {
             // Remove from library
             bool removed = false;
+            LibraryJournal::Category category = LibraryJournal::Category::Backgrounds;
             for (int i = 0; i < m_library.backgrounds.size(); i++) {
                 if (m_library.backgrounds[i].id == asset.id) {
                     m_library.backgrounds.removeAt(i);
+                    m_bgIndex.remove(i);
                     removed = true;
                     break;
                 }
@@ -783,6 +962,8 @@ void VelutanDockWidget::onAssetAction(const Asset &asset, const QString &action)
                 for (int i = 0; i < m_library.characters.size(); i++) {
                     if (m_library.characters[i].id == asset.id) {
                         m_library.characters.removeAt(i);
+                        m_charIndex.remove(i);
+                        category = LibraryJournal::Category::Characters;
                         removed = true;
                         break;
                     }
@@ -790,10 +971,8 @@ void VelutanDockWidget::onAssetAction(const Asset &asset, const QString &action)
             }
             
             if (removed) {
-                // Save library
-                QString userPath = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation)
-                        + "/velutan-image-manager/library.json";
-                AssetLibrary::saveToFile(userPath, m_library);
+                // Save library; only the removal is written
+                m_librarySaver.record(LibraryJournal::Op::Remove, category, asset, m_library);
                 
                 // If it was a background, clear BG_Stage if it's showing this image
                 bool wasBackground = false;
@@ -808,6 +987,7 @@ void VelutanDockWidget::onAssetAction(const Asset &asset, const QString &action)
                 if (!wasBackground) {
                     // It was removed from backgrounds, clear BG_Stage
                     m_obs.setBackground(m_config.selectedScene, m_config.bgTargetName, "", false);
+                    m_bgPool.showTarget(m_config.selectedScene, m_config.bgTargetName);
                 }
                 
                 // Update filters and refresh lists
@@ -849,21 +1029,14 @@ void VelutanDockWidget::onGridToggled(bool enabled)
     saveConfig();
     
     if (enabled) {
-        // Generate grid image
-        uint32_t width, height;
-        m_obs.getCanvasSize(width, height);
-        
-        QString gridImagePath = m_obs.generateGridImage(width, height, m_config.gridSize,
-                                                         m_config.gridColor, m_config.gridOpacity);
-        
-        if (!gridImagePath.isEmpty()) {
-            m_obs.ensureGridOverlay(m_config.selectedScene, gridImagePath, m_config.gridShowInStream);
-            m_obs.toggleGridOverlay(m_config.selectedScene, true);
-            
-            // If pinned sources exist, bring them to front
-            if (!m_config.pinnedSources.isEmpty()) {
-                m_obs.bringPinnedToFront(m_config.selectedScene, m_config.pinnedSources);
-            }
+        // Create or update the grid overlay, then show it with pinned
+        // sources still above it in one reorder
+        SceneBatch batch;
+        if (m_obs.ensureGrid(m_config.selectedScene, m_config.gridSize, m_config.gridColor,
+                             m_config.gridOpacity, m_config.gridShowInStream, &batch)) {
+            m_obs.toggleGridOverlay(m_config.selectedScene, true, &batch);
+            batch.keepOnTop(m_config.pinnedSources);
+            m_obs.apply(m_config.selectedScene, batch);
             
             m_toast->showMessage("📐 Grid enabled (" + QString::number(m_config.gridSize) + "px)");
         } else {
@@ -888,21 +1061,15 @@ void VelutanDockWidget::onGridSettings()
         m_config.gridOpacity = dialog.getGridOpacity();
         saveConfig();
         
-        // If grid is currently enabled, regenerate it
+        // If grid is currently enabled, regenerate it and apply the
+        // overlay and pinned sources as one batch
         if (m_config.gridEnabled) {
-            uint32_t width, height;
-            m_obs.getCanvasSize(width, height);
-            
-            QString gridImagePath = m_obs.generateGridImage(width, height, m_config.gridSize,
-                                                             m_config.gridColor, m_config.gridOpacity);
-            
-            if (!gridImagePath.isEmpty()) {
-                m_obs.ensureGridOverlay(m_config.selectedScene, gridImagePath, m_config.gridShowInStream);
-                
-                // If pinned sources exist, bring them to front
-                if (!m_config.pinnedSources.isEmpty()) {
-                    m_obs.bringPinnedToFront(m_config.selectedScene, m_config.pinnedSources);
-                }
+            SceneBatch batch;
+            if (m_obs.ensureGrid(m_config.selectedScene, m_config.gridSize, m_config.gridColor,
+                                 m_config.gridOpacity, m_config.gridShowInStream, &batch)) {
+                m_obs.toggleGridOverlay(m_config.selectedScene, true, &batch);
+                batch.keepOnTop(m_config.pinnedSources);
+                m_obs.apply(m_config.selectedScene, batch);
             }
         }
         
@@ -910,8 +1077,42 @@ void VelutanDockWidget::onGridSettings()
     }
 }
 
+void VelutanDockWidget::onSnapAll()
+{
+    // Every character source of this scene, or only those tagged with
+    // the character tag filter's selection
+    GridSnapOptions options;
+    options.gridSize = m_config.gridSize;
+    options.prefix = m_config.selectedScene + "_" + m_config.overlayPrefix;
+    options.skip = m_config.pinnedSources;
+    options.snapBounds = m_config.gridSnapBounds;
+    
+    const QString selectedCharTag = m_charTagFilter->currentText();
+    if (selectedCharTag != "🏷 All Tags" && !selectedCharTag.isEmpty()) {
+        for (const Asset &asset : std::as_const(m_library.characters)) {
+            if (asset.tags.contains(selectedCharTag))
+                options.sources.insert(options.prefix + asset.id);
+        }
+        if (options.sources.isEmpty()) {
+            m_toast->showMessage("📐 No characters tagged " + selectedCharTag);
+            return;
+        }
+    }
+    
+    const int snapped = m_obs.snapAllToGrid(m_config.selectedScene, options);
+    m_toast->showMessage("📐 Snapped " + QString::number(snapped) + " source(s) to the "
+                         + QString::number(m_config.gridSize) + "px grid");
+}
+
 void VelutanDockWidget::updateFilterLists()
 {
+    // A sharded library has most assets unloaded; its manifest knows
+    // every theme and tag
+    QVector<ShardInfo> shards;
+    if (ShardedLibrary::enabled()) {
+        shards = ShardedLibrary::instance().shards();
+    }
+    
     // Populate theme filter
     QSet<QString> themes;
     for (const Asset &asset : m_library.backgrounds) {
@@ -919,6 +1120,11 @@ void VelutanDockWidget::updateFilterLists()
             themes.insert(asset.theme);
         }
     }
+    for (const ShardInfo &shard : shards) {
+        if (!shard.characters && !shard.theme.isEmpty()) {
+            themes.insert(shard.theme);
+        }
+    }
     
     m_themeFilter->clear();
     m_themeFilter->addItem("🌍 All Themes");
@@ -937,6 +1143,15 @@ void VelutanDockWidget::updateFilterLists()
             }
         }
     }
+    for (const ShardInfo &shard : shards) {
+        if (!shard.characters) {
+            for (const QString &tag : shard.tags) {
+                if (!tag.isEmpty()) {
+                    bgTags.insert(tag);
+                }
+            }
+        }
+    }
     
     m_bgTagFilter->clear();
     m_bgTagFilter->addItem("🏷 All Tags");
@@ -955,6 +1170,15 @@ void VelutanDockWidget::updateFilterLists()
             }
         }
     }
+    for (const ShardInfo &shard : shards) {
+        if (shard.characters) {
+            for (const QString &tag : shard.tags) {
+                if (!tag.isEmpty()) {
+                    charTags.insert(tag);
+                }
+            }
+        }
+    }
     
     m_charTagFilter->clear();
     m_charTagFilter->addItem("🏷 All Tags");
@@ -3,8 +3,12 @@
 #include <QWidget>
 
 #include "persistence.hpp"
+#include "config_store.hpp"
+#include "library_saver.hpp"
 #include "asset_library.hpp"
+#include "search_index.hpp"
 #include "obs_integration.hpp"
+#include "background_pool.hpp"
 
 /*
  * VelutanDockWidget
@@ -50,6 +54,7 @@ private slots:
     void onPinnedSourcesSettings();
     void onGridToggled(bool enabled);
     void onGridSettings();
+    void onSnapAll();
 
 private:
     void loadLibrary();
@@ -58,10 +63,18 @@ private:
     void updateSceneList();
     void updateFilterLists();
     void autoSetup();
+    void rebuildSearchIndex();
+    void loadVisibleShards();
+    void preloadBackgrounds(const Asset &current);
 
     PersistenceConfig m_config;
+    ConfigStore m_configStore;
+    LibrarySaver m_librarySaver;
     Library m_library;
+    SearchIndex m_bgIndex;    // Mirrors m_library.backgrounds row for row
+    SearchIndex m_charIndex;  // Mirrors m_library.characters row for row
     ObsIntegration m_obs;
+    BackgroundPool m_bgPool;
 
     HeaderBar *m_headerBar;
     QLineEdit *m_searchEdit;
@@ -0,0 +1,140 @@
+#include "grid_cache.hpp"
+#include "atomic_file.hpp"
+#include "grid_image.hpp"
+#include "persistence.hpp"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QImageWriter>
+#include <QDebug>
+
+extern "C" {
+#include <obs-module.h>
+}
+
+namespace {
+
+// Bumped whenever the rendering or encoding of grid images changes, so
+// images written by an older version are not picked up again
+const int kFormatVersion = 2;
+
+// Grid images kept on disk; enough for a few canvas sizes and styles
+const int kMaxCachedGrids = 8;
+
+// PNG writer quality; Qt maps it to zlib level 1.  The image is read
+// once, locally, so the default level's extra encode time buys nothing,
+// and the periodic rows compress well even at the fastest level.
+const int kPngQuality = 89;
+
+const char kFilePrefix[] = "grid-";
+const char kFileSuffix[] = ".png";
+
+} // namespace
+
+GridImageCache &GridImageCache::instance()
+{
+    static GridImageCache cache(configDirectory() + "/grids");
+    return cache;
+}
+
+GridImageCache::GridImageCache(const QString &directory) : m_directory(directory) {}
+
+QString GridImageCache::keyFor(int width, int height, int gridSize, const QColor &color)
+{
+    const QByteArray parameters = QStringLiteral("%1 %2x%3 %4 %5")
+                                          .arg(kFormatVersion)
+                                          .arg(width)
+                                          .arg(height)
+                                          .arg(gridSize)
+                                          .arg(color.name(QColor::HexArgb))
+                                          .toUtf8();
+    // 64 bits of the digest are plenty for a handful of files
+    return QString::fromLatin1(QCryptographicHash::hash(parameters, QCryptographicHash::Sha1).toHex().left(16));
+}
+
+QString GridImageCache::path(int width, int height, int gridSize, const QColor &color)
+{
+    const QString key = keyFor(width, height, gridSize, color);
+
+    // Seen this session; still checked on disk in case it was pruned
+    // or deleted by hand
+    auto it = m_paths.constFind(key);
+    if (it != m_paths.constEnd() && QFileInfo::exists(it.value()))
+        return it.value();
+
+    const QString file = fileFor(key);
+    if (QFileInfo::exists(file)) {
+        // Written by an earlier session; mark it recently used
+        QFile existing(file);
+        if (existing.open(QIODevice::ReadWrite))
+            existing.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+        m_paths.insert(key, file);
+        return file;
+    }
+
+    if (!render(file, width, height, gridSize, color))
+        return QString();
+    m_paths.insert(key, file);
+    prune();
+    return file;
+}
+
+QString GridImageCache::fileFor(const QString &key) const
+{
+    return m_directory + "/" + kFilePrefix + key + kFileSuffix;
+}
+
+bool GridImageCache::render(const QString &file, int width, int height, int gridSize, const QColor &color)
+{
+    if (!QDir().mkpath(m_directory)) {
+        qWarning() << "[Velutan] Could not create grid image folder" << m_directory;
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    // Palette image: one byte per pixel to filter and compress
+    QImage image = renderGridImageIndexed(width, height, gridSize, color);
+    if (image.isNull()) {
+        qWarning() << "[Velutan] Could not allocate a" << width << "x" << height << "grid image";
+        return false;
+    }
+    const qint64 renderMs = timer.restart();
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    QImageWriter writer(&buffer, "png");
+    writer.setQuality(kPngQuality);
+    if (!writer.write(image)) {
+        qWarning() << "[Velutan] Failed to encode grid image";
+        return false;
+    }
+    const qint64 encodeMs = timer.elapsed();
+    // A derived file; it can always be rendered again
+    if (!writeFileAtomically(file, data, Durability::Atomic)) {
+        qWarning() << "[Velutan] Failed to save grid image to" << file;
+        return false;
+    }
+    blog(LOG_INFO, "[Velutan] Grid image %dx%d rendered in %lld ms, encoded in %lld ms, %lld bytes", width,
+         height, (long long)renderMs, (long long)encodeMs, (long long)data.size());
+    return true;
+}
+
+void GridImageCache::prune()
+{
+    QDir dir(m_directory);
+    const QFileInfoList files =
+            dir.entryInfoList({QString(kFilePrefix) + "*" + kFileSuffix}, QDir::Files, QDir::Time);
+    // Newest first; everything past the limit goes
+    for (int i = kMaxCachedGrids; i < files.size(); ++i) {
+        QFile::remove(files.at(i).absoluteFilePath());
+        m_paths.remove(files.at(i).completeBaseName().mid(int(sizeof(kFilePrefix)) - 1));
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QColor>
+#include <QHash>
+#include <QString>
+
+/*
+ * grid_cache.hpp
+ *
+ * Content‑addressed store of generated grid overlay images, used when
+ * the procedural grid source is unavailable.  An image is keyed by a
+ * hash of everything that determines its pixels (canvas width and
+ * height, cell size, colour and opacity), so turning the grid off and
+ * on again, or reopening the grid settings without changing anything,
+ * finds the image already encoded instead of rendering it anew.  Grids
+ * for different canvas sizes live side by side under their own keys.
+ *
+ * Images are kept in the "grids" folder of the plugin's configuration
+ * directory, so they survive restarts, and remembered in memory for the
+ * session.  Only the most recently used few are kept on disk.
+ */
+
+class GridImageCache
+{
+public:
+    /** The process‑wide cache in the plugin's config directory. */
+    static GridImageCache &instance();
+
+    /**
+     * Path of the grid image for these parameters, rendering and
+     * storing it first if it is not cached.  The colour's alpha is the
+     * line opacity.  Returns an empty string on failure.
+     */
+    QString path(int width, int height, int gridSize, const QColor &color);
+
+    /** Cache key for a grid image; a hex digest of its parameters. */
+    static QString keyFor(int width, int height, int gridSize, const QColor &color);
+
+private:
+    explicit GridImageCache(const QString &directory);
+
+    QString fileFor(const QString &key) const;
+    bool render(const QString &file, int width, int height, int gridSize, const QColor &color);
+    void prune();
+
+    QString m_directory;
+    QHash<QString, QString> m_paths;  // Key → file, for images seen this session
+};
@@ -0,0 +1,87 @@
+#include "grid_image.hpp"
+
+#include <QPainter>
+#include <QPen>
+#include <QVector>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Fill dst (count pixels) by repeating the first period pixels of src,
+// doubling the copied span each time
+template<typename Pixel>
+void fillPeriodic(Pixel *dst, int count, const Pixel *src, int period)
+{
+    const int first = std::min(count, period);
+    std::memcpy(dst, src, size_t(first) * sizeof(Pixel));
+    for (int filled = first; filled < count;) {
+        const int chunk = std::min(filled, count - filled);
+        std::memcpy(dst + filled, dst, size_t(chunk) * sizeof(Pixel));
+        filled += chunk;
+    }
+}
+
+// One cell: row 0 is a line row, row 1 (if any) a gap row.  Painted
+// exactly as the full canvas used to be, vertical lines first.
+QImage paintCell(int gridSize, const QColor &color)
+{
+    const int tileHeight = gridSize > 1 ? 2 : 1;
+    QImage tile(gridSize, tileHeight, QImage::Format_ARGB32);
+    tile.fill(Qt::transparent);
+    QPainter painter(&tile);
+    painter.setRenderHint(QPainter::Antialiasing, false);  // Crisp lines
+    QPen pen(color);
+    pen.setWidth(1);
+    painter.setPen(pen);
+    painter.drawLine(0, 0, 0, tileHeight);
+    painter.drawLine(0, 0, gridSize, 0);
+    painter.end();
+    return tile;
+}
+
+// Copy the line row or gap row pattern into every row of the image
+template<typename Pixel>
+void fillRows(QImage &image, const Pixel *lineRow, const Pixel *gapRow, int gridSize)
+{
+    const size_t rowBytes = size_t(image.width()) * sizeof(Pixel);
+    for (int y = 0; y < image.height(); ++y)
+        std::memcpy(image.scanLine(y), (y % gridSize == 0) ? lineRow : gapRow, rowBytes);
+}
+
+} // namespace
+
+QImage renderGridImageIndexed(int width, int height, int gridSize, const QColor &color)
+{
+    if (width <= 0 || height <= 0)
+        return QImage();
+    gridSize = std::max(1, gridSize);
+
+    // The cell holds every colour of the grid
+    const QImage tile = paintCell(gridSize, color);
+    QVector<QRgb> palette;
+    QVector<uchar> cell(tile.width() * tile.height());
+    for (int y = 0; y < tile.height(); ++y) {
+        const QRgb *pixels = reinterpret_cast<const QRgb *>(tile.constScanLine(y));
+        for (int x = 0; x < tile.width(); ++x) {
+            int index = int(palette.indexOf(pixels[x]));
+            if (index < 0) {
+                index = int(palette.size());
+                palette << pixels[x];
+            }
+            cell[y * tile.width() + x] = uchar(index);
+        }
+    }
+
+    QImage image(width, height, QImage::Format_Indexed8);
+    if (image.isNull())
+        return QImage();
+    image.setColorTable(palette);
+
+    QVector<uchar> lineRow(width);
+    QVector<uchar> gapRow(width);
+    fillPeriodic(lineRow.data(), width, cell.constData(), gridSize);
+    fillPeriodic(gapRow.data(), width, cell.constData() + (tile.height() - 1) * tile.width(), gridSize);
+    fillRows(image, lineRow.constData(), gapRow.constData(), gridSize);
+    return image;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QColor>
+#include <QImage>
+
+/*
+ * grid_image.hpp
+ *
+ * Rasterises the grid overlay image used when the procedural grid
+ * source is unavailable (see grid_source.hpp).  The grid is periodic:
+ * every row of the image is either a "line row" (a horizontal line) or
+ * a "gap row" (only the vertical lines' pixels), and both repeat every
+ * cell horizontally.  So only a single cell is painted, with the same
+ * QPainter calls as before, which keeps the result pixel‑identical to
+ * painting the whole canvas; the two row patterns are then built from
+ * it by doubling memcpy and copied down the image.  Cost is one memcpy
+ * per row instead of a painter pass per line.
+ *
+ * The image is 8‑bit indexed: a grid holds only two or three colours,
+ * so a palette image is a quarter of the size of an ARGB32 one and
+ * encodes to a much smaller, faster palette PNG.
+ */
+
+/**
+ * Render a transparent width × height grid image with 1 px lines of the
+ * given colour every gridSize pixels, starting at 0.  The colour's alpha
+ * is the line opacity; the palette holds transparent, the line colour
+ * and, with translucent lines, the crossing colour.  Returns a null
+ * image for an empty canvas.
+ */
+QImage renderGridImageIndexed(int width, int height, int gridSize, const QColor &color);
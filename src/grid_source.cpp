@@ -0,0 +1,166 @@
+#include "grid_source.hpp"
+
+#include <obs-module.h>
+#include <graphics/vec4.h>
+
+namespace {
+
+gs_effect_t *s_effect = nullptr;
+
+struct GridSource {
+    obs_source_t *source = nullptr;
+    gs_eparam_t *sizeParam = nullptr;
+    gs_eparam_t *cellParam = nullptr;
+    gs_eparam_t *colorParam = nullptr;
+    int cellSize = 50;
+    vec4 color = {};  // Linear, alpha = opacity
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+const char *gridGetName(void *)
+{
+    return obs_module_text("GridSource");
+}
+
+void gridUpdate(void *data, obs_data_t *settings)
+{
+    auto *grid = static_cast<GridSource *>(data);
+    grid->cellSize = (int)obs_data_get_int(settings, VELUTAN_GRID_CELL_SIZE);
+    if (grid->cellSize < 1)
+        grid->cellSize = 1;
+    const uint32_t color = (uint32_t)obs_data_get_int(settings, VELUTAN_GRID_COLOR);
+    const uint32_t opacity = (uint32_t)obs_data_get_int(settings, VELUTAN_GRID_OPACITY) & 0xFF;
+    // Same 8-bit values the image held; rendered through an sRGB
+    // framebuffer like image_source, so the colour is linearised
+    vec4_from_rgba_srgb(&grid->color, (color & 0x00FFFFFF) | (opacity << 24));
+}
+
+void gridTick(void *data, float seconds);
+
+void *gridCreate(obs_data_t *settings, obs_source_t *source)
+{
+    auto *grid = new GridSource;
+    grid->source = source;
+    grid->sizeParam = gs_effect_get_param_by_name(s_effect, "size");
+    grid->cellParam = gs_effect_get_param_by_name(s_effect, "cell_size");
+    grid->colorParam = gs_effect_get_param_by_name(s_effect, "line_color");
+    gridUpdate(grid, settings);
+    gridTick(grid, 0.0f);
+    return grid;
+}
+
+void gridDestroy(void *data)
+{
+    delete static_cast<GridSource *>(data);
+}
+
+void gridGetDefaults(obs_data_t *settings)
+{
+    obs_data_set_default_int(settings, VELUTAN_GRID_CELL_SIZE, 50);
+    obs_data_set_default_int(settings, VELUTAN_GRID_COLOR, 0xFF00FF00);
+    obs_data_set_default_int(settings, VELUTAN_GRID_OPACITY, 128);
+}
+
+obs_properties_t *gridGetProperties(void *)
+{
+    obs_properties_t *props = obs_properties_create();
+    obs_properties_add_int(props, VELUTAN_GRID_CELL_SIZE, obs_module_text("GridSource.CellSize"), 1, 1000, 1);
+    obs_properties_add_color(props, VELUTAN_GRID_COLOR, obs_module_text("GridSource.Color"));
+    obs_properties_add_int_slider(props, VELUTAN_GRID_OPACITY, obs_module_text("GridSource.Opacity"), 0, 255, 1);
+    return props;
+}
+
+void gridTick(void *data, float)
+{
+    // Always canvas sized, like the image it replaces
+    auto *grid = static_cast<GridSource *>(data);
+    obs_video_info ovi;
+    if (obs_get_video_info(&ovi)) {
+        grid->width = ovi.base_width;
+        grid->height = ovi.base_height;
+    }
+}
+
+uint32_t gridGetWidth(void *data)
+{
+    return static_cast<GridSource *>(data)->width;
+}
+
+uint32_t gridGetHeight(void *data)
+{
+    return static_cast<GridSource *>(data)->height;
+}
+
+void gridRender(void *data, gs_effect_t *)
+{
+    auto *grid = static_cast<GridSource *>(data);
+    if (!s_effect || !grid->width || !grid->height)
+        return;
+
+    vec2 size;
+    vec2_set(&size, (float)grid->width, (float)grid->height);
+    gs_effect_set_vec2(grid->sizeParam, &size);
+    gs_effect_set_float(grid->cellParam, (float)grid->cellSize);
+    gs_effect_set_vec4(grid->colorParam, &grid->color);
+
+    const bool previous = gs_framebuffer_srgb_enabled();
+    gs_enable_framebuffer_srgb(true);
+    gs_blend_state_push();
+    gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+    while (gs_effect_loop(s_effect, "Draw"))
+        gs_draw_sprite(nullptr, 0, grid->width, grid->height);
+    gs_blend_state_pop();
+    gs_enable_framebuffer_srgb(previous);
+}
+
+} // namespace
+
+bool registerGridSource()
+{
+    char *path = obs_module_file("velutan_grid.effect");
+    if (!path) {
+        blog(LOG_WARNING, "[Velutan] Grid effect not found, using grid images");
+        return false;
+    }
+    obs_enter_graphics();
+    s_effect = gs_effect_create_from_file(path, nullptr);
+    obs_leave_graphics();
+    bfree(path);
+    if (!s_effect) {
+        blog(LOG_WARNING, "[Velutan] Could not load grid effect, using grid images");
+        return false;
+    }
+
+    obs_source_info info = {};
+    info.id = VELUTAN_GRID_SOURCE_ID;
+    info.type = OBS_SOURCE_TYPE_INPUT;
+    info.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW | OBS_SOURCE_SRGB;
+    info.get_name = gridGetName;
+    info.create = gridCreate;
+    info.destroy = gridDestroy;
+    info.update = gridUpdate;
+    info.get_defaults = gridGetDefaults;
+    info.get_properties = gridGetProperties;
+    info.video_tick = gridTick;
+    info.get_width = gridGetWidth;
+    info.get_height = gridGetHeight;
+    info.video_render = gridRender;
+    obs_register_source(&info);
+    return true;
+}
+
+void unregisterGridSource()
+{
+    if (!s_effect)
+        return;
+    obs_enter_graphics();
+    gs_effect_destroy(s_effect);
+    obs_leave_graphics();
+    s_effect = nullptr;
+}
+
+bool gridSourceAvailable()
+{
+    return s_effect != nullptr;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+/*
+ * grid_source.hpp
+ *
+ * The "velutan_grid_source" source type: a canvas‑sized grid overlay
+ * drawn procedurally by a pixel shader (data/velutan_grid.effect) from
+ * its cell size, colour and opacity settings.  Changing the settings is
+ * a settings update; no image is painted, encoded or decoded.
+ *
+ * It draws the same pixels the image from
+ * ObsIntegration::generateGridImage() contains: 1 px lines every
+ * cell_size pixels starting at 0, with the two strokes composited where
+ * lines cross.  That image path remains as the fallback when the
+ * effect cannot be loaded, in which case the type is not registered.
+ */
+
+/** Settings keys and id of the source type. */
+#define VELUTAN_GRID_SOURCE_ID "velutan_grid_source"
+#define VELUTAN_GRID_CELL_SIZE "cell_size"
+#define VELUTAN_GRID_COLOR     "color"    // 0xAABBGGRR, as OBS colour properties
+#define VELUTAN_GRID_OPACITY   "opacity"  // 0-255
+
+/** Load the effect and register the source type.  Call from
+ * obs_module_load().  Returns false if the effect is unavailable. */
+bool registerGridSource();
+
+/** Release the effect.  Call from obs_module_unload(). */
+void unregisterGridSource();
+
+/** True if registerGridSource() succeeded. */
+bool gridSourceAvailable();
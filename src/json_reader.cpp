@@ -0,0 +1,218 @@
+#include "json_reader.hpp"
+
+#include <cstring>
+
+JsonReader::JsonReader(const char *data, qint64 size)
+    : m_data(data), m_size(size)
+{
+    // Tolerate a UTF-8 byte order mark written by some editors
+    if (m_size >= 3 && std::memcmp(m_data, "\xEF\xBB\xBF", 3) == 0)
+        m_pos = 3;
+}
+
+bool JsonReader::beginObject()
+{
+    return expect('{');
+}
+
+bool JsonReader::nextMember(QByteArray *key)
+{
+    if (m_failed)
+        return false;
+    skipWhitespace();
+    if (m_pos < m_size && m_data[m_pos] == ',') {
+        ++m_pos;
+        skipWhitespace();
+    }
+    if (m_pos >= m_size)
+        return fail();
+    if (m_data[m_pos] == '}') {
+        ++m_pos;
+        return false;
+    }
+    if (m_data[m_pos] != '"')
+        return fail();
+    const qint64 begin = m_pos + 1;
+    if (!skipString())
+        return false;
+    *key = QByteArray::fromRawData(m_data + begin, int(m_pos - 1 - begin));
+    return expect(':');
+}
+
+bool JsonReader::beginArray()
+{
+    return expect('[');
+}
+
+bool JsonReader::nextElement()
+{
+    if (m_failed)
+        return false;
+    skipWhitespace();
+    if (m_pos < m_size && m_data[m_pos] == ',') {
+        ++m_pos;
+        skipWhitespace();
+    }
+    if (m_pos >= m_size)
+        return fail();
+    if (m_data[m_pos] == ']') {
+        ++m_pos;
+        return false;
+    }
+    return true;
+}
+
+bool JsonReader::atString()
+{
+    skipWhitespace();
+    return m_pos < m_size && m_data[m_pos] == '"';
+}
+
+bool JsonReader::atArray()
+{
+    skipWhitespace();
+    return m_pos < m_size && m_data[m_pos] == '[';
+}
+
+bool JsonReader::readString(QString *out)
+{
+    if (m_failed)
+        return false;
+    if (!atString())
+        return fail();
+    const qint64 begin = m_pos + 1;
+
+    // Most strings have no escapes and convert in one go
+    qint64 i = begin;
+    while (i < m_size && m_data[i] != '"' && m_data[i] != '\\')
+        ++i;
+    if (i >= m_size)
+        return fail();
+    QString result = QString::fromUtf8(m_data + begin, int(i - begin));
+    while (i < m_size) {
+        if (m_data[i] == '"') {
+            *out = result;
+            m_pos = i + 1;
+            return true;
+        }
+        if (m_data[i] != '\\') {
+            const qint64 run = i;
+            while (i < m_size && m_data[i] != '"' && m_data[i] != '\\')
+                ++i;
+            result += QString::fromUtf8(m_data + run, int(i - run));
+            continue;
+        }
+        if (++i >= m_size)
+            break;
+        switch (m_data[i]) {
+        case '"': result += QLatin1Char('"'); break;
+        case '\\': result += QLatin1Char('\\'); break;
+        case '/': result += QLatin1Char('/'); break;
+        case 'b': result += QLatin1Char('\b'); break;
+        case 'f': result += QLatin1Char('\f'); break;
+        case 'n': result += QLatin1Char('\n'); break;
+        case 'r': result += QLatin1Char('\r'); break;
+        case 't': result += QLatin1Char('\t'); break;
+        case 'u': {
+            // Surrogate pairs arrive as two escapes and simply become
+            // two UTF-16 units
+            if (i + 4 >= m_size)
+                return fail();
+            bool ok = false;
+            const ushort unit = QByteArray::fromRawData(m_data + i + 1, 4).toUShort(&ok, 16);
+            if (!ok)
+                return fail();
+            result += QChar(unit);
+            i += 4;
+            break;
+        }
+        default:
+            return fail();
+        }
+        ++i;
+    }
+    return fail();
+}
+
+bool JsonReader::skipValue()
+{
+    if (m_failed)
+        return false;
+    skipWhitespace();
+    if (m_pos >= m_size)
+        return fail();
+    const char c = m_data[m_pos];
+    if (c == '"')
+        return skipString();
+    if (c == '{' || c == '[') {
+        // Only brackets and strings have to balance, so a malformed
+        // entry can still be stepped over as a whole
+        int depth = 0;
+        while (m_pos < m_size) {
+            const char d = m_data[m_pos];
+            if (d == '"') {
+                if (!skipString())
+                    return false;
+                continue;
+            }
+            ++m_pos;
+            if (d == '{' || d == '[')
+                ++depth;
+            else if ((d == '}' || d == ']') && --depth == 0)
+                return true;
+        }
+        return fail();
+    }
+    // Number or literal: everything up to the next separator
+    const qint64 begin = m_pos;
+    while (m_pos < m_size && !std::strchr(",]} \t\r\n", m_data[m_pos]))
+        ++m_pos;
+    if (m_pos == begin)
+        return fail();
+    return true;
+}
+
+void JsonReader::skipWhitespace()
+{
+    while (m_pos < m_size) {
+        const char c = m_data[m_pos];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+            break;
+        ++m_pos;
+    }
+}
+
+bool JsonReader::expect(char c)
+{
+    if (m_failed)
+        return false;
+    skipWhitespace();
+    if (m_pos >= m_size || m_data[m_pos] != c)
+        return fail();
+    ++m_pos;
+    return true;
+}
+
+bool JsonReader::skipString()
+{
+    // Positioned on the opening quote
+    qint64 i = m_pos + 1;
+    while (i < m_size) {
+        if (m_data[i] == '\\') {
+            i += 2;
+            continue;
+        }
+        if (m_data[i] == '"') {
+            m_pos = i + 1;
+            return true;
+        }
+        ++i;
+    }
+    return fail();
+}
+
+bool JsonReader::fail()
+{
+    m_failed = true;
+    return false;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+
+/*
+ * json_reader.hpp
+ *
+ * A minimal pull parser for UTF‑8 JSON.  Instead of building a
+ * QJsonDocument the caller walks the input token by token and reads
+ * only the values it wants straight into its own structures, so
+ * loading a file costs little more memory than the result itself.
+ *
+ * The reader is deliberately forgiving about separators (a missing or
+ * doubled comma is accepted) and its skipValue() only needs brackets
+ * and strings to balance, which lets callers step over an entry they
+ * failed to read and carry on with the next one.  Numbers and literals
+ * are never interpreted, only skipped.
+ */
+
+class JsonReader
+{
+public:
+    /** Read from data, which must outlive the reader. */
+    JsonReader(const char *data, qint64 size);
+
+    /** Consume the '{' starting an object. */
+    bool beginObject();
+
+    /** Advance to the next member of the current object and return its
+     * key, positioned on the value.  Returns false once the closing '}'
+     * has been consumed or on error.  The key is the raw text between
+     * the quotes and only valid while the input is. */
+    bool nextMember(QByteArray *key);
+
+    /** Consume the '[' starting an array. */
+    bool beginArray();
+
+    /** Advance to the next element of the current array.  Returns false
+     * once the closing ']' has been consumed or on error. */
+    bool nextElement();
+
+    /** True if the next value is a string. */
+    bool atString();
+
+    /** True if the next value is an array. */
+    bool atArray();
+
+    /** Read a string value, decoding escapes. */
+    bool readString(QString *out);
+
+    /** Skip over the next value whatever it is, including a malformed
+     * object or array as long as its brackets balance. */
+    bool skipValue();
+
+    bool failed() const { return m_failed; }
+    void clearError() { m_failed = false; }
+
+    /** Offset of the next unread byte, for reporting and for seek(). */
+    qint64 position() const { return m_pos; }
+    void seek(qint64 pos) { m_pos = pos; }
+
+private:
+    void skipWhitespace();
+    bool expect(char c);
+    bool skipString();
+    bool fail();
+
+    const char *m_data;
+    qint64 m_size;
+    qint64 m_pos = 0;
+    bool m_failed = false;
+};
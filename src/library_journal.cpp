@@ -0,0 +1,306 @@
+#include "library_journal.hpp"
+#include "persistence.hpp"
+#include "atomic_file.hpp"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QMutexLocker>
+#include <QDebug>
+
+namespace {
+
+const int kJournalVersion = 1;
+
+// Owned by the module, see LibraryJournal::createInstance()
+LibraryJournal *g_instance = nullptr;
+
+// Journal size past which library.json is rewritten in the background
+const qint64 kCompactThreshold = 256 * 1024;
+
+struct Stamp {
+    qint64 size = -1;
+    qint64 mtime = -1;
+    bool operator==(const Stamp &other) const { return size == other.size && mtime == other.mtime; }
+    bool operator!=(const Stamp &other) const { return !(*this == other); }
+};
+
+Stamp stampOf(const QString &path)
+{
+    Stamp stamp;
+    QFileInfo info(path);
+    if (info.exists()) {
+        stamp.size = info.size();
+        stamp.mtime = info.lastModified().toMSecsSinceEpoch();
+    }
+    return stamp;
+}
+
+QByteArray headerFor(const Stamp &stamp)
+{
+    QJsonObject obj;
+    obj.insert("journal", kJournalVersion);
+    obj.insert("jsonSize", stamp.size);
+    obj.insert("jsonMtime", stamp.mtime);
+    return QJsonDocument(obj).toJson(QJsonDocument::Compact) + '\n';
+}
+
+bool headerMatches(const QByteArray &line, const Stamp &stamp)
+{
+    const QJsonObject obj = QJsonDocument::fromJson(line).object();
+    return obj.value("journal").toInt() == kJournalVersion
+            && obj.value("jsonSize").toInteger(-1) == stamp.size
+            && obj.value("jsonMtime").toInteger(-1) == stamp.mtime;
+}
+
+// Open the journal and position it after a header matching stamp.
+// Returns false if there is no journal or it belongs to another file.
+bool openMatching(QFile &file, const Stamp &stamp)
+{
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    return headerMatches(file.readLine(), stamp);
+}
+
+// Row lookup by id for one asset list, rebuilt lazily after removals
+struct RowIndex {
+    QVector<Asset> *list;
+    QHash<QString, int> rows;
+    bool dirty = true;
+
+    int find(const QString &id)
+    {
+        if (dirty) {
+            rows.clear();
+            for (int i = 0; i < list->size(); ++i)
+                rows.insert(list->at(i).id, i);
+            dirty = false;
+        }
+        return rows.value(id, -1);
+    }
+};
+
+int applyRecords(const QByteArray &records, Library *lib)
+{
+    RowIndex backgrounds{&lib->backgrounds};
+    RowIndex characters{&lib->characters};
+    int applied = 0;
+    for (const QByteArray &line : records.split('\n')) {
+        if (line.trimmed().isEmpty())
+            continue;
+        QJsonParseError err;
+        const QJsonObject obj = QJsonDocument::fromJson(line, &err).object();
+        if (err.error != QJsonParseError::NoError)
+            continue;  // A torn last line left by a crash
+        const QString category = obj.value("category").toString();
+        RowIndex *index = category == QLatin1String("backgrounds") ? &backgrounds
+                : category == QLatin1String("characters") ? &characters
+                : nullptr;
+        if (!index)
+            continue;
+
+        const QString op = obj.value("op").toString();
+        if (op == QLatin1String("remove")) {
+            const int row = index->find(obj.value("id").toString());
+            if (row >= 0) {
+                index->list->removeAt(row);
+                index->dirty = true;
+            }
+        } else if (op == QLatin1String("add") || op == QLatin1String("update")) {
+            Asset asset = AssetLibrary::assetFromJson(obj.value("asset").toObject());
+            AssetLibrary::internAsset(*lib, asset);
+            const int row = index->find(asset.id);
+            if (row >= 0) {
+                (*index->list)[row] = asset;
+            } else {
+                index->rows.insert(asset.id, index->list->size());
+                index->list->push_back(asset);
+            }
+        } else {
+            continue;
+        }
+        ++applied;
+    }
+    return applied;
+}
+
+} // namespace
+
+LibraryJournal &LibraryJournal::instance()
+{
+    Q_ASSERT(g_instance);
+    return *g_instance;
+}
+
+void LibraryJournal::createInstance()
+{
+    if (!g_instance)
+        g_instance = new LibraryJournal(libraryFilePath());
+}
+
+void LibraryJournal::destroyInstance()
+{
+    if (!g_instance)
+        return;
+    g_instance->waitForCompaction();
+    delete g_instance;
+    g_instance = nullptr;
+}
+
+LibraryJournal::LibraryJournal(const QString &jsonPath)
+    : m_jsonPath(jsonPath), m_path(pathFor(jsonPath))
+{
+    m_pool.setMaxThreadCount(1);
+}
+
+LibraryJournal::~LibraryJournal()
+{
+    m_pool.waitForDone();
+}
+
+QString LibraryJournal::pathFor(const QString &jsonPath)
+{
+    QFileInfo info(jsonPath);
+    return info.path() + "/" + info.completeBaseName() + ".journal";
+}
+
+int LibraryJournal::replay(Library *lib)
+{
+    QByteArray records;
+    {
+        QMutexLocker locker(&m_mutex);
+        QFile file(m_path);
+        if (!openMatching(file, stampOf(m_jsonPath)))
+            return 0;
+        records = file.readAll();
+    }
+    return applyRecords(records, lib);
+}
+
+bool LibraryJournal::hasBase() const
+{
+    return QFileInfo::exists(m_jsonPath);
+}
+
+bool LibraryJournal::record(const QVector<Change> &changes)
+{
+    if (changes.isEmpty())
+        return true;
+    // Still running off the bundled library: the first change has to
+    // create the user's library.json with save()
+    if (!hasBase())
+        return false;
+
+    QByteArray lines;
+    for (const Change &change : changes) {
+        QJsonObject obj;
+        obj.insert("op", change.op == Op::Add ? "add" : change.op == Op::Update ? "update" : "remove");
+        obj.insert("category", change.category == Category::Backgrounds ? "backgrounds" : "characters");
+        if (change.op == Op::Remove)
+            obj.insert("id", change.asset.id);
+        else
+            obj.insert("asset", AssetLibrary::assetToJson(change.asset));
+        lines += QJsonDocument(obj).toJson(QJsonDocument::Compact) + '\n';
+    }
+
+    QMutexLocker locker(&m_mutex);
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadWrite)) {
+        qWarning() << "[Velutan] Could not open library journal" << m_path;
+        return false;
+    }
+    // A journal left over from another library.json starts afresh
+    const Stamp stamp = stampOf(m_jsonPath);
+    if (file.size() == 0 || !headerMatches(file.readLine(), stamp)) {
+        file.resize(0);
+        file.seek(0);
+        file.write(headerFor(stamp));
+    }
+    file.seek(file.size());
+    if (file.write(lines) != lines.size()
+            || (defaultDurability() != Durability::Atomic && !syncFile(file))) {
+        qWarning() << "[Velutan] Could not write library journal" << m_path;
+        return false;
+    }
+    file.close();
+
+    const qint64 size = QFileInfo(m_path).size();
+    if (size > kCompactThreshold && !m_compacting) {
+        m_compacting = true;
+        m_pool.start([this, size]() { compact(size); });
+    }
+    return true;
+}
+
+bool LibraryJournal::save(const Library &lib)
+{
+    if (!lib.complete) {
+        qWarning() << "[Velutan] Not saving" << m_jsonPath << "over a library that was only partly loaded";
+        return false;
+    }
+    QMutexLocker locker(&m_mutex);
+    if (!AssetLibrary::saveToFile(m_jsonPath, lib))
+        return false;
+    resetLocked();
+    return true;
+}
+
+void LibraryJournal::waitForCompaction()
+{
+    m_pool.waitForDone();
+}
+
+void LibraryJournal::compact(qint64 offset)
+{
+    // Rebuild from disk rather than from a caller's copy, so changes
+    // journaled by the dock and the setup dialog are all kept.  Only
+    // the final write holds the lock; if library.json is replaced in
+    // the meantime the compaction is simply abandoned.
+    Stamp base;
+    QByteArray records;
+    {
+        QMutexLocker locker(&m_mutex);
+        base = stampOf(m_jsonPath);
+        QFile file(m_path);
+        if (openMatching(file, base))
+            records = file.read(offset - file.pos());
+    }
+    Library lib;
+    if (!records.isEmpty()) {
+        lib = AssetLibrary::loadFromFile(m_jsonPath);
+        applyRecords(records, &lib);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_compacting = false;
+    if (records.isEmpty() || stampOf(m_jsonPath) != base)
+        return;
+    // Rewriting a library.json that could only partly be read would
+    // drop everything after the damage; keep journaling on top of it
+    if (!lib.complete) {
+        qWarning() << "[Velutan] Not compacting library journal:" << m_jsonPath << "is malformed";
+        return;
+    }
+    // Records appended meanwhile go into the new library.json too, so
+    // it holds every change before the journal is emptied.  A crash
+    // between the two writes leaves a journal whose header no longer
+    // matches and is ignored, which loses nothing.
+    QFile file(m_path);
+    if (!openMatching(file, base) || !file.seek(offset))
+        return;
+    applyRecords(file.readAll(), &lib);
+    file.close();
+    if (AssetLibrary::saveToFile(m_jsonPath, lib))
+        resetLocked();
+}
+
+bool LibraryJournal::resetLocked()
+{
+    // Start over, empty, against the library.json now on disk
+    if (!writeFileAtomically(m_path, headerFor(stampOf(m_jsonPath)))) {
+        qWarning() << "[Velutan] Could not reset library journal" << m_path;
+        return false;
+    }
+    return true;
+}
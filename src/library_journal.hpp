@@ -0,0 +1,93 @@
+#pragma once
+
+#include <QMutex>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+
+#include "asset_library.hpp"
+
+/*
+ * library_journal.hpp
+ *
+ * An append‑only change log kept next to the user's library.json
+ * (library.journal).  Adding, editing or deleting one asset appends a
+ * single compact JSON line describing the change instead of rewriting
+ * the whole library, so an edit costs a few hundred bytes of I/O.
+ *
+ * The first line of the journal records the size and modification time
+ * of the library.json it applies to; a journal that does not match the
+ * current file is ignored and started afresh.  Records are replayed on
+ * top of library.json at load.  Each one is an upsert or removal by
+ * asset id, so replaying a record that library.json already contains
+ * is harmless, and a torn last line left by a crash is skipped.
+ *
+ * Once the journal grows past a threshold it is compacted on a
+ * background thread: library.json is rebuilt from disk plus every
+ * journaled record and the journal restarts empty.  A library.json
+ * that cannot be read in full is never compacted.  The journal is safe
+ * to use from any thread.
+ */
+
+class LibraryJournal
+{
+public:
+    enum class Op { Add, Update, Remove };
+    enum class Category { Backgrounds, Characters };
+
+    /** One change to one asset.  Removals only use the asset's id. */
+    struct Change {
+        Op op;
+        Category category;
+        Asset asset;
+    };
+
+    /** The journal of the user library in the plugin's config directory.
+     * Only valid between createInstance() and destroyInstance(). */
+    static LibraryJournal &instance();
+
+    /** Create the journal at module load.  It owns a thread pool, so it
+     * must not be a static that outlives Qt at process teardown. */
+    static void createInstance();
+
+    /** Wait for a running compaction and destroy the journal, at module
+     * unload once nothing writes the library any more. */
+    static void destroyInstance();
+
+    explicit LibraryJournal(const QString &jsonPath);
+    ~LibraryJournal();
+
+    /** Path of the journal belonging to a library JSON file. */
+    static QString pathFor(const QString &jsonPath);
+
+    /** Apply the journal to lib, which must have been loaded from this
+     * journal's library.json.  Returns the number of records applied. */
+    int replay(Library *lib);
+
+    /** True once there is a library.json to journal against.  Until
+     * then changes have to be saved in full with save(). */
+    bool hasBase() const;
+
+    /**
+     * Append a batch of changes with a single write.  Fails if there is
+     * no library.json yet.  Returns true on success.
+     */
+    bool record(const QVector<Change> &changes);
+
+    /** Save lib in full and empty the journal.  Returns true on success;
+     * a library that was only partly loaded is never saved. */
+    bool save(const Library &lib);
+
+    /** Block until a running compaction has finished. */
+    void waitForCompaction();
+
+private:
+    void compact(qint64 offset);
+    bool resetLocked();
+
+    QString m_jsonPath;
+    QString m_path;
+    QMutex m_mutex;             // Serialises all access to both files
+    QThreadPool m_pool;         // Runs compaction
+    bool m_compacting = false;  // Guarded by m_mutex
+};
@@ -0,0 +1,133 @@
+#include "library_saver.hpp"
+#include "library_shards.hpp"
+
+#include <QMutexLocker>
+
+namespace {
+
+// Changes arriving within this window are written together
+const int kCoalesceIntervalMs = 200;
+
+} // namespace
+
+LibrarySaver::LibrarySaver(QObject *parent)
+    : QObject(parent)
+{
+    m_pool.setMaxThreadCount(1);
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(kCoalesceIntervalMs);
+    connect(&m_timer, &QTimer::timeout, this, &LibrarySaver::writePending);
+}
+
+LibrarySaver::~LibrarySaver()
+{
+    flush();
+}
+
+quint64 LibrarySaver::record(LibraryJournal::Op op, LibraryJournal::Category category,
+                             const Asset &asset, const Library &lib)
+{
+    if (ShardedLibrary::enabled()) {
+        recordShard(category, asset, lib);
+    } else if (m_fullSave) {
+        // The queued full save simply picks up the newer library
+        m_latest = lib;
+        schedule();
+    } else if (!LibraryJournal::instance().hasBase()) {
+        // Still running off the bundled library; the first change
+        // creates the user's library.json
+        save(lib);
+    } else {
+        m_changes.push_back(LibraryJournal::Change{op, category, asset});
+        schedule();
+    }
+    // Everything queued goes out with the next write
+    return m_issued + 1;
+}
+
+void LibrarySaver::recordShard(LibraryJournal::Category category, const Asset &asset,
+                               const Library &lib)
+{
+    ShardedLibrary &shards = ShardedLibrary::instance();
+    if (!shards.exists()) {
+        // The first change creates the shards from the whole library
+        save(lib);
+        return;
+    }
+    // Shards are rewritten from the library itself, so it is always kept
+    m_latest = lib;
+    if (!m_fullSave)
+        m_dirtyShards += shards.keysTouchedBy(category == LibraryJournal::Category::Characters, asset);
+    schedule();
+}
+
+quint64 LibrarySaver::save(const Library &lib)
+{
+    m_latest = lib;
+    m_fullSave = true;
+    m_changes.clear();
+    m_dirtyShards.clear();
+    schedule();
+    return m_issued + 1;
+}
+
+void LibrarySaver::flush()
+{
+    m_timer.stop();
+    writePending();
+    m_pool.waitForDone();
+    // Queued deliveries die with the saver, which may be about to go
+    // with its dialog
+    deliverResults();
+}
+
+void LibrarySaver::schedule()
+{
+    if (!m_timer.isActive())
+        m_timer.start();
+}
+
+void LibrarySaver::writePending()
+{
+    if (!m_fullSave && m_changes.isEmpty() && m_dirtyShards.isEmpty())
+        return;
+    const bool sharded = ShardedLibrary::enabled();
+    const bool fullSave = m_fullSave;
+    const Library lib = m_latest;
+    const QVector<LibraryJournal::Change> changes = m_changes;
+    const QSet<QString> dirtyShards = m_dirtyShards;
+    // Drop our references so later edits on the GUI side do not detach
+    m_fullSave = false;
+    m_latest = Library();
+    m_changes.clear();
+    m_dirtyShards.clear();
+
+    const quint64 write = ++m_issued;
+
+    m_pool.start([this, write, sharded, fullSave, lib, changes, dirtyShards]() {
+        bool ok;
+        if (sharded) {
+            ShardedLibrary &shards = ShardedLibrary::instance();
+            ok = fullSave ? shards.saveAll(lib) : shards.save(lib, dirtyShards);
+        } else {
+            LibraryJournal &journal = LibraryJournal::instance();
+            ok = fullSave ? journal.save(lib) : journal.record(changes);
+        }
+        {
+            QMutexLocker locker(&m_resultsMutex);
+            m_results.push_back(Result{write, ok});
+        }
+        QMetaObject::invokeMethod(this, &LibrarySaver::deliverResults, Qt::QueuedConnection);
+    });
+}
+
+void LibrarySaver::deliverResults()
+{
+    QVector<Result> results;
+    {
+        QMutexLocker locker(&m_resultsMutex);
+        results.swap(m_results);
+    }
+    for (const Result &result : std::as_const(results))
+        emit finished(result.ok, result.write);
+}
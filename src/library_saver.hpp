@@ -0,0 +1,86 @@
+#pragma once
+
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
+
+#include "asset_library.hpp"
+#include "library_journal.hpp"
+
+/*
+ * library_saver.hpp
+ *
+ * Takes library writes off the GUI thread.  Dialog handlers hand their
+ * changes to a LibrarySaver and return immediately; the saver collects
+ * everything that arrives within a short window and then writes it on
+ * a worker thread in one go: a batch of changes becomes a single
+ * journal append, and any number of full saves becomes one write of
+ * the latest library.  Deleting or retagging hundreds of assets in one
+ * handler therefore costs exactly one write.
+ *
+ * Full saves receive the Library by value.  Its containers are
+ * implicitly shared, so handing it over copies nothing; the GUI's own
+ * copy only detaches if it is edited while a write is still pending.
+ * The outcome of every write is reported through finished(), tagged
+ * with the write's sequence number, which record() and save() return
+ * so a caller can tell its own write apart from one already running.
+ *
+ * With the sharded layout (library_shards.hpp) changes are not
+ * journaled; instead the saver remembers which shards they touch and
+ * rewrites just those from the latest library.
+ */
+
+class LibrarySaver : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LibrarySaver(QObject *parent = nullptr);
+    ~LibrarySaver();
+
+    /** Queue a change to one asset.  lib is the library with the change
+     * applied; it is only kept if the change cannot be journaled, i.e.
+     * the library has to be saved in full or is sharded.  Returns the
+     * sequence number of the write that will carry the change. */
+    quint64 record(LibraryJournal::Op op, LibraryJournal::Category category,
+                   const Asset &asset, const Library &lib);
+
+    /** Queue a full save of lib, superseding any queued changes.
+     * Returns the sequence number of the write that will save it. */
+    quint64 save(const Library &lib);
+
+    /** Write everything queued now, wait until it is on disk and report
+     * every outstanding result before returning. */
+    void flush();
+
+signals:
+    /** The write with the given sequence number finished.  Delivered on
+     * the saver's thread, in order. */
+    void finished(bool ok, quint64 write);
+
+private slots:
+    void writePending();
+    void deliverResults();
+
+private:
+    struct Result {
+        quint64 write;
+        bool ok;
+    };
+
+    void schedule();
+    void recordShard(LibraryJournal::Category category, const Asset &asset, const Library &lib);
+
+    QThreadPool m_pool;  // A single thread, so writes land in order
+    QTimer m_timer;
+    QVector<LibraryJournal::Change> m_changes;
+    QSet<QString> m_dirtyShards;  // Sharded layout: shards to rewrite
+    Library m_latest;  // Only held while a full save or shard write is queued
+    bool m_fullSave = false;
+    quint64 m_issued = 0;  // Sequence number of the last write started
+
+    QMutex m_resultsMutex;
+    QVector<Result> m_results;  // Finished, not yet reported; guarded by m_resultsMutex
+};
@@ -0,0 +1,361 @@
+#include "library_shards.hpp"
+#include "library_journal.hpp"
+#include "library_snapshot.hpp"
+#include "persistence.hpp"
+#include "atomic_file.hpp"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QDebug>
+
+#include <atomic>
+
+namespace {
+
+const int kManifestVersion = 1;
+const char kManifestName[] = "manifest.json";
+const char kCharactersKey[] = "characters";
+const char kBackgroundsPrefix[] = "backgrounds/";
+
+std::atomic<bool> s_enabled{false};
+
+bool isCharactersKey(const QString &key)
+{
+    return key == QLatin1String(kCharactersKey);
+}
+
+QString themeOfKey(const QString &key)
+{
+    return key.mid(int(sizeof(kBackgroundsPrefix)) - 1);
+}
+
+QString keyOf(bool characters, const Asset &asset)
+{
+    return ShardedLibrary::keyFor(characters, asset.theme);
+}
+
+} // namespace
+
+ShardedLibrary &ShardedLibrary::instance()
+{
+    static ShardedLibrary shards(configDirectory() + "/library");
+    return shards;
+}
+
+ShardedLibrary::ShardedLibrary(const QString &directory)
+    : m_directory(directory)
+{
+}
+
+bool ShardedLibrary::enabled()
+{
+    return s_enabled.load();
+}
+
+void ShardedLibrary::setEnabled(bool enabled)
+{
+    s_enabled.store(enabled);
+}
+
+QString ShardedLibrary::keyFor(bool characters, const QString &theme)
+{
+    if (characters)
+        return QString::fromLatin1(kCharactersKey);
+    return QLatin1String(kBackgroundsPrefix) + theme;
+}
+
+bool ShardedLibrary::exists()
+{
+    QMutexLocker locker(&m_mutex);
+    readManifestLocked();
+    return !m_shards.isEmpty();
+}
+
+QVector<ShardInfo> ShardedLibrary::shards()
+{
+    QMutexLocker locker(&m_mutex);
+    readManifestLocked();
+    return QVector<ShardInfo>(m_shards.begin(), m_shards.end());
+}
+
+QStringList ShardedLibrary::backgroundKeys()
+{
+    QMutexLocker locker(&m_mutex);
+    readManifestLocked();
+    QStringList keys;
+    for (const ShardInfo &info : std::as_const(m_shards)) {
+        if (!info.characters)
+            keys << info.key;
+    }
+    return keys;
+}
+
+int ShardedLibrary::load(Library *lib, const QStringList &keys)
+{
+    QMutexLocker locker(&m_mutex);
+    readManifestLocked();
+
+    // Ids already present, built on first use per category: an asset
+    // moved into a shard that was not loaded yet is in lib already
+    QSet<QString> backgroundIds, characterIds;
+    bool haveBackgroundIds = false, haveCharacterIds = false;
+
+    int loaded = 0;
+    for (const QString &key : keys) {
+        if (lib->shards.contains(key) || !m_shards.contains(key))
+            continue;
+        const ShardInfo info = m_shards.value(key);
+        Library part = AssetLibrary::loadFromFile(m_directory + "/" + info.file);
+        if (!part.complete)
+            lib->complete = false;
+
+        QVector<Asset> &target = info.characters ? lib->characters : lib->backgrounds;
+        QSet<QString> &ids = info.characters ? characterIds : backgroundIds;
+        bool &haveIds = info.characters ? haveCharacterIds : haveBackgroundIds;
+        if (!haveIds) {
+            for (const Asset &asset : std::as_const(target))
+                ids.insert(asset.id);
+            haveIds = true;
+        }
+
+        const QVector<Asset> &source = info.characters ? part.characters : part.backgrounds;
+        target.reserve(target.size() + source.size());
+        for (Asset asset : source) {
+            if (ids.contains(asset.id))
+                continue;
+            AssetLibrary::internAsset(*lib, asset);
+            ids.insert(asset.id);
+            if (!info.characters)
+                m_backgroundKeys.insert(asset.id, key);
+            target.push_back(asset);
+        }
+        lib->shards.insert(key);
+        ++loaded;
+    }
+    return loaded;
+}
+
+int ShardedLibrary::loadAll(Library *lib)
+{
+    QStringList keys;
+    for (const ShardInfo &info : shards())
+        keys << info.key;
+    return load(lib, keys);
+}
+
+QSet<QString> ShardedLibrary::keysTouchedBy(bool characters, const Asset &asset)
+{
+    QSet<QString> keys{keyOf(characters, asset)};
+    if (!characters) {
+        QMutexLocker locker(&m_mutex);
+        const QString previous = m_backgroundKeys.value(asset.id);
+        if (!previous.isEmpty())
+            keys.insert(previous);
+    }
+    return keys;
+}
+
+bool ShardedLibrary::save(const Library &lib, const QSet<QString> &keys)
+{
+    if (!lib.complete) {
+        qWarning() << "[Velutan] Not saving library shards from a library that was only partly loaded";
+        return false;
+    }
+    QMutexLocker locker(&m_mutex);
+    readManifestLocked();
+    QDir().mkpath(m_directory);
+
+    bool ok = true;
+    for (const QString &key : keys) {
+        const bool characters = isCharactersKey(key);
+        const QVector<Asset> &list = characters ? lib.characters : lib.backgrounds;
+
+        QVector<Asset> assets;
+        QSet<QString> elsewhere;  // Ids lib holds in some other shard
+        for (const Asset &asset : list) {
+            if (keyOf(characters, asset) == key)
+                assets.push_back(asset);
+            else
+                elsewhere.insert(asset.id);
+        }
+
+        const QString fileName = m_shards.contains(key) ? m_shards.value(key).file : fileNameFor(key);
+        const QString path = m_directory + "/" + fileName;
+
+        // lib never loaded this shard: keep what is on disk, with lib's
+        // own assets taking precedence and those it moved away dropped
+        if (m_shards.contains(key) && !lib.shards.contains(key)) {
+            QSet<QString> ids;
+            for (const Asset &asset : std::as_const(assets))
+                ids.insert(asset.id);
+            const Library disk = AssetLibrary::loadFromFile(path);
+            if (!disk.complete) {
+                qWarning() << "[Velutan] Not rewriting partly readable shard" << path;
+                ok = false;
+                continue;
+            }
+            QVector<Asset> kept;
+            for (const Asset &asset : characters ? disk.characters : disk.backgrounds) {
+                if (!ids.contains(asset.id) && !elsewhere.contains(asset.id))
+                    kept.push_back(asset);
+            }
+            assets = kept + assets;
+        }
+
+        if (assets.isEmpty()) {
+            // An emptied shard disappears along with its snapshot
+            if (m_shards.remove(key)) {
+                QFile::remove(path);
+                QFile::remove(LibrarySnapshot::pathFor(path));
+            }
+            continue;
+        }
+
+        Library shard;
+        (characters ? shard.characters : shard.backgrounds) = assets;
+        if (!AssetLibrary::saveToFile(path, shard)) {
+            ok = false;
+            continue;
+        }
+
+        ShardInfo info;
+        info.key = key;
+        info.file = fileName;
+        info.characters = characters;
+        info.theme = characters ? QString() : themeOfKey(key);
+        info.count = assets.size();
+        QSet<QString> seen;
+        for (const Asset &asset : std::as_const(assets)) {
+            for (const QString &tag : asset.tags) {
+                if (!seen.contains(tag)) {
+                    seen.insert(tag);
+                    info.tags << tag;
+                }
+            }
+            if (!characters)
+                m_backgroundKeys.insert(asset.id, key);
+        }
+        m_shards.insert(key, info);
+    }
+    return writeManifestLocked() && ok;
+}
+
+bool ShardedLibrary::saveAll(const Library &lib)
+{
+    QSet<QString> keys = lib.shards;
+    for (const Asset &asset : lib.backgrounds)
+        keys.insert(keyOf(false, asset));
+    if (!lib.characters.isEmpty())
+        keys.insert(keyFor(true));
+    return save(lib, keys);
+}
+
+void ShardedLibrary::migrate()
+{
+    const bool sharded = exists();
+    if (enabled() && !sharded) {
+        // Nothing of the user's yet: the first save creates the shards
+        if (!QFileInfo::exists(libraryFilePath()))
+            return;
+        Library lib = AssetLibrary::loadFromFile(libraryFilePath());
+        LibraryJournal::instance().replay(&lib);
+        if (saveAll(lib)) {
+            qInfo() << "[Velutan] Split library.json into" << shards().size()
+                    << "shards in" << m_directory;
+        }
+    } else if (!enabled() && sharded) {
+        Library lib;
+        loadAll(&lib);
+        if (!LibraryJournal::instance().save(lib))
+            return;
+        // library.json is authoritative again; the shard files stay as
+        // a backup but without a manifest they are never read
+        QMutexLocker locker(&m_mutex);
+        QFile::remove(m_directory + "/" + kManifestName);
+        m_shards.clear();
+        m_backgroundKeys.clear();
+        qInfo() << "[Velutan] Merged library shards back into library.json";
+    }
+}
+
+void ShardedLibrary::readManifestLocked()
+{
+    if (m_manifestRead)
+        return;
+    m_manifestRead = true;
+
+    QFile file(m_directory + "/" + kManifestName);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    if (root.value("version").toInt() != kManifestVersion) {
+        qWarning() << "[Velutan] Ignoring library manifest with unknown version" << file.fileName();
+        return;
+    }
+    for (const QJsonValue &val : root.value("shards").toArray()) {
+        const QJsonObject obj = val.toObject();
+        ShardInfo info;
+        info.characters = obj.value("category").toString() == QLatin1String("characters");
+        info.theme = obj.value("theme").toString();
+        info.key = keyFor(info.characters, info.theme);
+        info.file = obj.value("file").toString();
+        info.count = obj.value("count").toInt();
+        for (const QJsonValue &tag : obj.value("tags").toArray())
+            info.tags << tag.toString();
+        // File names are ours; never follow one out of the directory
+        if (info.file.isEmpty() || info.file.contains('/') || info.file.contains('\\'))
+            continue;
+        m_shards.insert(info.key, info);
+    }
+}
+
+bool ShardedLibrary::writeManifestLocked()
+{
+    QJsonArray shards;
+    for (const ShardInfo &info : std::as_const(m_shards)) {
+        QJsonObject obj;
+        obj.insert("category", info.characters ? "characters" : "backgrounds");
+        if (!info.characters)
+            obj.insert("theme", info.theme);
+        obj.insert("file", info.file);
+        obj.insert("count", info.count);
+        obj.insert("tags", QJsonArray::fromStringList(info.tags));
+        shards.append(obj);
+    }
+    QJsonObject root;
+    root.insert("version", kManifestVersion);
+    root.insert("shards", shards);
+
+    const QString path = m_directory + "/" + kManifestName;
+    if (!writeFileAtomically(path, QJsonDocument(root).toJson(QJsonDocument::Indented))) {
+        qWarning() << "[Velutan] Could not write library manifest" << path;
+        return false;
+    }
+    return true;
+}
+
+QString ShardedLibrary::fileNameFor(const QString &key) const
+{
+    if (isCharactersKey(key))
+        return QStringLiteral("characters.json");
+    const QString theme = themeOfKey(key);
+    if (theme.isEmpty())
+        return QStringLiteral("backgrounds.json");
+
+    // Readable but filesystem‑safe, with a hash so "Sci-Fi" and "Sci Fi"
+    // do not collide
+    QString readable;
+    for (const QChar c : theme) {
+        if (readable.size() >= 32)
+            break;
+        readable += (c.isLetterOrNumber() && c.unicode() < 128) ? c.toLower() : QChar('_');
+    }
+    const QByteArray hash = QCryptographicHash::hash(theme.toUtf8(), QCryptographicHash::Md5).toHex().left(8);
+    return QStringLiteral("backgrounds-%1-%2.json").arg(readable, QString::fromLatin1(hash));
+}
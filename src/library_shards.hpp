@@ -0,0 +1,102 @@
+#pragma once
+
+#include <QMap>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include "asset_library.hpp"
+
+/*
+ * library_shards.hpp
+ *
+ * Optional sharded layout of the user library: instead of a single
+ * library.json, the "library" directory next to it holds manifest.json
+ * plus one file per shard, characters.json for all characters and one
+ * backgrounds‑<theme>.json per background theme.  Shard files use the
+ * library.json format (and so get their own binary snapshots).
+ *
+ * The manifest lists every shard with its theme, asset count and tags,
+ * which is enough to fill the dock's filter lists without loading any
+ * assets.  Shards are then loaded into a Library on demand with load();
+ * Library::shards records which ones a given Library holds.  Saving
+ * rewrites only the shards that changed.  A changed shard that the
+ * Library does not hold (an asset moved to a theme that was never
+ * loaded) is merged with its file on disk rather than overwritten.
+ *
+ * The layout is switched with setEnabled(), from the "shardedLibrary"
+ * config value; migrate() converts the files on disk in either
+ * direction.  Safe to use from any thread.
+ */
+
+struct ShardInfo {
+    QString key;       // See keyFor()
+    QString file;      // File name inside the shard directory
+    bool characters = false;
+    QString theme;     // Backgrounds only; may be empty
+    int count = 0;
+    QStringList tags;  // Every tag used in the shard
+};
+
+class ShardedLibrary
+{
+public:
+    /** The shards of the user library in the plugin's config directory. */
+    static ShardedLibrary &instance();
+
+    explicit ShardedLibrary(const QString &directory);
+
+    /** Whether the user library uses the sharded layout. */
+    static bool enabled();
+    static void setEnabled(bool enabled);
+
+    /** Shard key for characters, or for backgrounds of a theme. */
+    static QString keyFor(bool characters, const QString &theme = QString());
+
+    /** True if a manifest exists, i.e. the library has been sharded. */
+    bool exists();
+
+    /** Every shard listed in the manifest. */
+    QVector<ShardInfo> shards();
+
+    /** Keys of the background shards. */
+    QStringList backgroundKeys();
+
+    /**
+     * Load the given shards into lib, skipping those it already holds
+     * and assets whose id it already has.  A shard that is only partly
+     * readable marks lib incomplete.  Returns the number of shards
+     * loaded.
+     */
+    int load(Library *lib, const QStringList &keys);
+
+    /** Load every shard into lib. */
+    int loadAll(Library *lib);
+
+    /** Keys of the shards a change to asset may touch: the shard it
+     * belongs to now and the one it was last saved in. */
+    QSet<QString> keysTouchedBy(bool characters, const Asset &asset);
+
+    /** Rewrite the given shards from lib and update the manifest.
+     * Returns true on success; refuses an incomplete lib. */
+    bool save(const Library &lib, const QSet<QString> &keys);
+
+    /** Rewrite every shard lib holds or has assets for. */
+    bool saveAll(const Library &lib);
+
+    /** Convert the user library on disk to the layout selected with
+     * setEnabled(), if it is not in that layout yet. */
+    void migrate();
+
+private:
+    void readManifestLocked();
+    bool writeManifestLocked();
+    QString fileNameFor(const QString &key) const;
+
+    QString m_directory;
+    QMutex m_mutex;
+    bool m_manifestRead = false;
+    QMap<QString, ShardInfo> m_shards;         // By key, guarded by m_mutex
+    QHash<QString, QString> m_backgroundKeys;  // Asset id → shard last seen in
+};
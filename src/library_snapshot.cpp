@@ -0,0 +1,202 @@
+#include "library_snapshot.hpp"
+#include "atomic_file.hpp"
+#include "persistence.hpp"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <cstring>
+
+namespace {
+
+const quint32 kMagic = 0x564c534e;  // "VLSN"
+const quint32 kVersion = 1;
+const quint32 kNoString = 0xffffffffu;
+const int kRecordFields = 6;
+
+struct Header {
+    quint32 magic;
+    quint32 version;
+    qint64 jsonSize;
+    qint64 jsonMtime;
+    quint32 stringCount;
+    quint32 backgroundCount;
+    quint32 characterCount;
+    quint32 tagRefCount;
+};
+static_assert(sizeof(Header) == 40, "snapshot header must not contain padding");
+
+bool jsonStamp(const QString &jsonPath, qint64 *size, qint64 *mtime)
+{
+    QFileInfo info(jsonPath);
+    if (!info.exists())
+        return false;
+    *size = info.size();
+    *mtime = info.lastModified().toMSecsSinceEpoch();
+    return true;
+}
+
+} // namespace
+
+QString LibrarySnapshot::pathFor(const QString &jsonPath)
+{
+    const QFileInfo info(jsonPath);
+    const QString config = QDir(configDirectory()).absolutePath();
+    const QString dir = info.absolutePath();
+    if (dir == config || dir.startsWith(config + "/"))
+        return dir + "/" + info.completeBaseName() + ".bin";
+    // Anything else, such as the bundled library in the OBS install
+    // directory, gets its snapshot in the config directory, named after
+    // a hash of its path
+    const QByteArray hash = QCryptographicHash::hash(info.absoluteFilePath().toUtf8(),
+                                                     QCryptographicHash::Md5).toHex().left(8);
+    return config + "/snapshots/" + info.completeBaseName() + "-" + QString::fromLatin1(hash) + ".bin";
+}
+
+bool LibrarySnapshot::load(const QString &jsonPath, Library *lib)
+{
+    qint64 jsonSize, jsonMtime;
+    if (!jsonStamp(jsonPath, &jsonSize, &jsonMtime))
+        return false;
+    QFile file(pathFor(jsonPath));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    const qint64 size = file.size();
+    if (size < qint64(sizeof(Header)))
+        return false;
+    // Unmapped again when file goes out of scope; every string is copied
+    // out before that
+    const uchar *base = file.map(0, size);
+    if (!base)
+        return false;
+
+    Header header;
+    std::memcpy(&header, base, sizeof(Header));
+    if (header.magic != kMagic || header.version != kVersion)
+        return false;
+    if (header.jsonSize != jsonSize || header.jsonMtime != jsonMtime)
+        return false;
+
+    // Every section must lie inside the file before anything is read
+    const quint64 assetCount = quint64(header.backgroundCount) + header.characterCount;
+    const quint64 offsetsPos = sizeof(Header);
+    const quint64 recordsPos = offsetsPos + (quint64(header.stringCount) + 1) * 4;
+    const quint64 tagRefsPos = recordsPos + assetCount * kRecordFields * 4;
+    const quint64 textPos = tagRefsPos + quint64(header.tagRefCount) * 4;
+    if (textPos > quint64(size))
+        return false;
+    const quint32 *offsets = reinterpret_cast<const quint32 *>(base + offsetsPos);
+    const quint32 *records = reinterpret_cast<const quint32 *>(base + recordsPos);
+    const quint32 *tagRefs = reinterpret_cast<const quint32 *>(base + tagRefsPos);
+    const QChar *text = reinterpret_cast<const QChar *>(base + textPos);
+    const quint64 textUnits = (quint64(size) - textPos) / 2;
+
+    const quint32 stringCount = header.stringCount;
+    QVector<QString> strings(stringCount);
+    for (quint32 i = 0; i < stringCount; ++i) {
+        const quint32 begin = offsets[i];
+        const quint32 end = offsets[i + 1];
+        if (begin > end || end > textUnits)
+            return false;
+        strings[i] = QString(text + begin, end - begin);
+    }
+
+    Library result;
+    auto readAssets = [&](quint32 first, quint32 count, QVector<Asset> *list) {
+        list->reserve(count);
+        for (quint32 i = first; i < first + count; ++i) {
+            const quint32 *record = records + quint64(i) * kRecordFields;
+            if (record[0] >= stringCount || record[1] >= stringCount || record[2] >= stringCount)
+                return false;
+            if (record[3] != kNoString && record[3] >= stringCount)
+                return false;
+            if (quint64(record[4]) + record[5] > header.tagRefCount)
+                return false;
+            Asset a;
+            a.id = strings[record[0]];
+            a.name = strings[record[1]];
+            a.file = strings[record[2]];
+            if (record[3] != kNoString)
+                a.theme = strings[record[3]];
+            a.tags.reserve(record[5]);
+            for (quint32 t = 0; t < record[5]; ++t) {
+                const quint32 tag = tagRefs[record[4] + t];
+                if (tag >= stringCount)
+                    return false;
+                a.tags << strings[tag];
+            }
+            AssetLibrary::internAsset(result, a);
+            list->push_back(a);
+        }
+        return true;
+    };
+    if (!readAssets(0, header.backgroundCount, &result.backgrounds)
+            || !readAssets(header.backgroundCount, header.characterCount, &result.characters))
+        return false;
+
+    *lib = result;
+    return true;
+}
+
+bool LibrarySnapshot::save(const QString &jsonPath, const Library &lib)
+{
+    Header header = {};
+    header.magic = kMagic;
+    header.version = kVersion;
+    if (!jsonStamp(jsonPath, &header.jsonSize, &header.jsonMtime))
+        return false;
+
+    QHash<QString, quint32> ids;
+    QVector<quint32> offsets(1, 0);
+    QString text;
+    auto addString = [&](const QString &s) {
+        auto it = ids.constFind(s);
+        if (it != ids.constEnd())
+            return it.value();
+        const quint32 id = quint32(offsets.size() - 1);
+        text += s;
+        offsets.push_back(quint32(text.size()));
+        ids.insert(s, id);
+        return id;
+    };
+
+    QVector<quint32> records;
+    records.reserve((lib.backgrounds.size() + lib.characters.size()) * kRecordFields);
+    QVector<quint32> tagRefs;
+    auto addAssets = [&](const QVector<Asset> &list) {
+        for (const Asset &a : list) {
+            records.push_back(addString(a.id));
+            records.push_back(addString(a.name));
+            records.push_back(addString(a.file));
+            records.push_back(a.theme.isEmpty() ? kNoString : addString(a.theme));
+            records.push_back(quint32(tagRefs.size()));
+            records.push_back(quint32(a.tags.size()));
+            for (const QString &tag : a.tags)
+                tagRefs.push_back(addString(tag));
+        }
+    };
+    addAssets(lib.backgrounds);
+    addAssets(lib.characters);
+
+    header.stringCount = quint32(offsets.size() - 1);
+    header.backgroundCount = quint32(lib.backgrounds.size());
+    header.characterCount = quint32(lib.characters.size());
+    header.tagRefCount = quint32(tagRefs.size());
+
+    QByteArray data;
+    data.reserve(int(sizeof(Header)) + (offsets.size() + records.size() + tagRefs.size()) * 4
+                 + text.size() * 2);
+    data.append(reinterpret_cast<const char *>(&header), sizeof(Header));
+    data.append(reinterpret_cast<const char *>(offsets.constData()), offsets.size() * 4);
+    data.append(reinterpret_cast<const char *>(records.constData()), records.size() * 4);
+    data.append(reinterpret_cast<const char *>(tagRefs.constData()), tagRefs.size() * 4);
+    data.append(reinterpret_cast<const char *>(text.constData()), text.size() * 2);
+
+    // Only a cache of the JSON, so it is not worth an fsync
+    const QString path = pathFor(jsonPath);
+    if (!QDir().mkpath(QFileInfo(path).absolutePath()))
+        return false;
+    return writeFileAtomically(path, data, Durability::Atomic);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QString>
+
+#include "asset_library.hpp"
+
+/*
+ * library_snapshot.hpp
+ *
+ * A compact binary copy of library.json that loads without any parsing.
+ * AssetLibrary writes it after every load or save of the JSON and
+ * prefers it on the next load.  Snapshots are only ever written in the
+ * plugin's config directory: next to a JSON file that lives there
+ * (library.json → library.bin), and under snapshots/ for any other,
+ * such as the bundled library in the OBS install directory.  The
+ * snapshot records the size and modification time of the JSON it was
+ * made from, so a JSON file edited by hand or by an older version of
+ * the plugin is simply parsed again and the snapshot regenerated.
+ *
+ * Layout, native byte order, all offsets in bytes from the file start:
+ *
+ *   header           magic, version, JSON size and mtime, counts
+ *   string offsets   stringCount + 1 × u32, in UTF‑16 units
+ *   asset records    (backgrounds + characters) × 6 × u32:
+ *                    id, name, file, theme (string indexes, theme
+ *                    kNoString when empty), first tag ref, tag count
+ *   tag refs         tagRefCount × u32 string indexes
+ *   string data      UTF‑16, every distinct string stored once
+ *
+ * The file is memory‑mapped on load; each distinct string is turned
+ * into a QString once and shared by every asset that uses it.
+ */
+
+class LibrarySnapshot
+{
+public:
+    /** Path of the snapshot belonging to a library JSON file. */
+    static QString pathFor(const QString &jsonPath);
+
+    /**
+     * Load the snapshot belonging to jsonPath into lib.  Returns false,
+     * leaving lib untouched, if there is no snapshot, it is corrupt, or
+     * it was not made from the current contents of jsonPath.
+     */
+    static bool load(const QString &jsonPath, Library *lib);
+
+    /**
+     * Write the snapshot of lib for the current contents of jsonPath.
+     * Returns true on success.
+     */
+    static bool save(const QString &jsonPath, const Library &lib);
+};
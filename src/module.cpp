@@ -4,6 +4,9 @@
 
 #include "dock_widget.hpp"
 #include "setup_dialog.hpp"
+#include "grid_source.hpp"
+#include "library_journal.hpp"
+#include "ui/ThumbnailCache.hpp"
 
 /*
  * This file implements the OBS module entry points.  When the plugin is
@@ -33,6 +36,12 @@ bool obs_module_load(void)
 {
     blog(LOG_INFO, "[Velutan] Loading Velutan Image Manager plugin");
 
+    // Procedural grid overlay; without it the grid falls back to images
+    registerGridSource();
+
+    // The library journal is used by the dock and the setup dialog
+    LibraryJournal::createInstance();
+
     // Create the dock widget (QWidget, not QDockWidget)
     blog(LOG_INFO, "[Velutan] Creating dock widget...");
     try {
@@ -40,14 +49,17 @@ bool obs_module_load(void)
         blog(LOG_INFO, "[Velutan] Dock widget created successfully");
     } catch (const std::exception &e) {
         blog(LOG_ERROR, "[Velutan] Exception creating dock widget: %s", e.what());
+        LibraryJournal::destroyInstance();
         return false;
     } catch (...) {
         blog(LOG_ERROR, "[Velutan] Unknown exception creating dock widget");
+        LibraryJournal::destroyInstance();
         return false;
     }
     
     if (!g_dock) {
         blog(LOG_ERROR, "[Velutan] Dock widget is null");
+        LibraryJournal::destroyInstance();
         return false;
     }
     
@@ -65,6 +77,7 @@ bool obs_module_load(void)
         blog(LOG_ERROR, "[Velutan] Failed to register dock with OBS");
         delete g_dock;
         g_dock = nullptr;
+        LibraryJournal::destroyInstance();
         return false;
     }
     
@@ -115,4 +128,13 @@ void obs_module_unload(void)
         // The dock widget will be deleted by OBS
     g_dock = nullptr;
     }
+    
+    unregisterGridSource();
+
+    // The dock flushed its library writes when it was removed above
+    LibraryJournal::destroyInstance();
+    
+    // In case the dock was never created or outlives us; the cached
+    // pixmaps must not reach static destruction
+    ThumbnailCache::instance().clear();
 }
\ No newline at end of file
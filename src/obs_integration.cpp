@@ -1,25 +1,48 @@
 #include "obs_integration.hpp"
+#include "grid_source.hpp"
+#include "grid_cache.hpp"
 
 #include <QDebug>
-#include <QImage>
-#include <QPainter>
 #include <QColor>
-#include <QStandardPaths>
 #include <QDir>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Source holding the grid overlay image in every scene
+const char kGridSourceName[] = "Velutan_Grid_Overlay";
+
+// Round a position to the nearest grid point
+vec2 snappedToGrid(const vec2 &pos, int gridSize)
+{
+    vec2 snapped;
+    snapped.x = roundf(pos.x / gridSize) * gridSize;
+    snapped.y = roundf(pos.y / gridSize) * gridSize;
+    return snapped;
+}
+
+} // namespace
 
 ObsIntegration::ObsIntegration(QObject *parent)
     : QObject(parent)
 {
+    connect(&m_mirror, &SceneMirror::sceneChanged, this, &ObsIntegration::sceneChanged);
 }
 
 ObsIntegration::~ObsIntegration()
 {
+    const SourceCache::Stats stats = m_handles.stats();
+    blog(LOG_INFO, "[Velutan] Handle cache: %llu lookups avoided, %llu misses, %llu invalidations",
+         (unsigned long long)stats.hits, (unsigned long long)stats.misses,
+         (unsigned long long)stats.invalidations);
 }
 
 bool ObsIntegration::ensureScene(const QString &sceneName)
 {
     // Try to find an existing scene.  Scenes are sources of type "scene".
-    obs_source_t *sceneSource = obs_get_source_by_name(sceneName.toUtf8().constData());
+    obs_source_t *sceneSource = m_handles.source(sceneName);
     if (sceneSource) {
         obs_source_release(sceneSource);
         return true;
@@ -54,11 +77,11 @@ bool ObsIntegration::ensureBackgroundTarget(const QString &sceneName, const QStr
     QString sceneSpecificName = sceneName + "_" + sourceName;
     
     // Check if the source already exists globally.
-    obs_source_t *existing = obs_get_source_by_name(sceneSpecificName.toUtf8().constData());
+    obs_source_t *existing = m_handles.source(sceneSpecificName);
     
     if (existing) {
         // Source exists, but check if it's in this scene
-        obs_sceneitem_t *item = obs_scene_find_source(scene, sceneSpecificName.toUtf8().constData());
+        obs_sceneitem_t *item = findSceneItem(scene, sceneSpecificName);
         if (!item) {
             // Source exists but not in this scene, add it
             item = obs_scene_add(scene, existing);
@@ -106,7 +129,7 @@ void ObsIntegration::setBackground(const QString &sceneName, const QString &sour
         QString sceneSpecificName = sceneName + "_" + sourceName;
         
         // Get the background source by name
-        obs_source_t *source = obs_get_source_by_name(sceneSpecificName.toUtf8().constData());
+        obs_source_t *source = m_handles.source(sceneSpecificName);
         if (!source) {
             qWarning() << "[Velutan] Background source not found:" << sceneSpecificName;
             return;
@@ -126,7 +149,7 @@ void ObsIntegration::setBackground(const QString &sceneName, const QString &sour
             obs_video_info ovi;
             if (obs_get_video_info(&ovi)) {
                 // Find the scene item in the specified scene
-                obs_sceneitem_t *item = obs_scene_find_source(scene, sceneSpecificName.toUtf8().constData());
+                obs_sceneitem_t *item = findSceneItem(scene, sceneSpecificName);
                 if (item) {
                     struct vec2 bounds;
                     bounds.x = (float)ovi.base_width;
@@ -140,12 +163,14 @@ void ObsIntegration::setBackground(const QString &sceneName, const QString &sour
         obs_source_update(source, settings);
         obs_data_release(settings);
         obs_source_release(source);
+        m_mirror.noteFile(sceneSpecificName, filePath);
     } catch (...) {
         blog(LOG_ERROR, "[Velutan] Exception in setBackground");
     }
 }
 
-bool ObsIntegration::ensureCharacter(const QString &sceneName, const QString &sourceName, const QString &filePath)
+bool ObsIntegration::ensureCharacter(const QString &sceneName, const QString &sourceName, const QString &filePath,
+                                     SceneBatch *batch)
 {
     if (!ensureScene(sceneName))
         return false;
@@ -153,7 +178,7 @@ bool ObsIntegration::ensureCharacter(const QString &sceneName, const QString &so
     if (!scene) {
         return false;
     }
-    obs_source_t *existing = obs_get_source_by_name(sourceName.toUtf8().constData());
+    obs_source_t *existing = m_handles.source(sourceName);
     if (!existing) {
         // Create new image source with the specified file.
         obs_data_t *settings = obs_data_create();
@@ -175,43 +200,34 @@ bool ObsIntegration::ensureCharacter(const QString &sceneName, const QString &so
     } else {
         // Update existing source file and ensure it is visible.
         obs_sceneitem_t *item = findSceneItem(scene, sourceName);
+        obs_source_release(existing);
         if (!item) {
             qWarning() << "[Velutan] Could not find scene item for" << sourceName;
-            obs_source_release(existing);
             return false;
         }
-        obs_sceneitem_set_visible(item, true);
-        // Update file path
-        obs_data_t *settings = obs_source_get_settings(existing);
-        obs_data_set_string(settings, "file", filePath.toUtf8().constData());
-        obs_source_update(existing, settings);
-        obs_data_release(settings);
-        obs_sceneitem_set_order(item, OBS_ORDER_MOVE_TOP);
-        obs_source_release(existing);
+        SceneBatch own;
+        SceneBatch &changes = batch ? *batch : own;
+        changes.setVisible(sourceName, true);
+        changes.setFile(sourceName, filePath);
+        changes.raise(sourceName);
+        if (!batch)
+            apply(sceneName, own);
         return true;
     }
 }
 
 void ObsIntegration::toggleCharacter(const QString &sceneName, const QString &sourceName, bool visible)
 {
-    obs_scene_t *scene = getScene(sceneName);
-    if (!scene)
-        return;
-    obs_sceneitem_t *item = findSceneItem(scene, sourceName);
-    if (item) {
-        obs_sceneitem_set_visible(item, visible);
-    }
+    SceneBatch batch;
+    batch.setVisible(sourceName, visible);
+    apply(sceneName, batch);
 }
 
 void ObsIntegration::bringToFront(const QString &sceneName, const QString &sourceName)
 {
-    obs_scene_t *scene = getScene(sceneName);
-    if (!scene)
-        return;
-    obs_sceneitem_t *item = findSceneItem(scene, sourceName);
-    if (item) {
-        obs_sceneitem_set_order(item, OBS_ORDER_MOVE_TOP);
-    }
+    SceneBatch batch;
+    batch.raise(sourceName);
+    apply(sceneName, batch);
 }
 
 bool ObsIntegration::isVisible(const QString &sceneName, const QString &sourceName) const
@@ -225,45 +241,191 @@ bool ObsIntegration::isVisible(const QString &sceneName, const QString &sourceNa
     return obs_sceneitem_visible(item);
 }
 
+QHash<QString, SceneItemState> ObsIntegration::sceneSnapshot(const QString &sceneName)
+{
+    return m_mirror.items(sceneName);
+}
+
 void ObsIntegration::bringPinnedToFront(const QString &sceneName, const QStringList &pinnedSourceNames)
 {
     if (pinnedSourceNames.isEmpty())
         return;
-        
+    
+    // One reorder for all of them, the first in the list on top
+    SceneBatch batch;
+    batch.keepOnTop(pinnedSourceNames);
+    apply(sceneName, batch);
+}
+
+bool ObsIntegration::apply(const QString &sceneName, const SceneBatch &batch)
+{
+    if (batch.isEmpty())
+        return true;
     obs_scene_t *scene = getScene(sceneName);
     if (!scene)
-        return;
-    
-    // Bring each pinned source to the top, in reverse order so the first in
-    // the list ends up at the very top
-    for (int i = pinnedSourceNames.size() - 1; i >= 0; --i) {
-        const QString &sourceName = pinnedSourceNames[i];
-        obs_sceneitem_t *item = findSceneItem(scene, sourceName);
-        if (item) {
-            obs_sceneitem_set_order(item, OBS_ORDER_MOVE_TOP);
-        }
+        return false;
+
+    // Resolve every item up front; lookups outside the scene lock are
+    // served from the handle cache
+    struct Update {
+        QVector<QPair<obs_sceneitem_t *, const SceneBatch::Change *>> changes;
+        SceneOrderRequest order;
+    } update;
+    for (const SceneBatch::Change &change : batch.m_changes) {
+        obs_sceneitem_t *item = findSceneItem(scene, change.source);
+        if (item)
+            update.changes.push_back(qMakePair(item, &change));
+    }
+    update.order = batch.m_order;
+    if (!update.order.isEmpty()) {
+        // Whatever else moves, the grid stays above the content
+        update.order.overlay = kGridSourceName;
+    }
+
+    // Files belong to the sources and never touch the scene
+    for (const auto &entry : std::as_const(update.changes)) {
+        if (!entry.second->setFile)
+            continue;
+        obs_source_t *source = obs_sceneitem_get_source(entry.first);
+        obs_data_t *settings = source ? obs_source_get_settings(source) : nullptr;
+        if (!settings)
+            continue;
+        obs_data_set_string(settings, "file", entry.second->file.toUtf8().constData());
+        obs_source_update(source, settings);
+        obs_data_release(settings);
+        m_mirror.noteFile(entry.second->source, entry.second->file);
     }
+
+    // Everything else under one scene lock.  The item list is read and
+    // reordered inside the same update, as obs_scene_reorder_items()
+    // needs every top‑level item of the scene.
+    obs_scene_atomic_update(scene, [](void *data, obs_scene_t *scene) {
+        auto *update = static_cast<Update *>(data);
+        for (const auto &entry : std::as_const(update->changes)) {
+            obs_sceneitem_t *item = entry.first;
+            const SceneBatch::Change &change = *entry.second;
+            if (change.setVisible)
+                obs_sceneitem_set_visible(item, change.visible);
+            if (change.setPosition)
+                obs_sceneitem_set_pos(item, &change.position);
+            if (change.setBounds) {
+                obs_sceneitem_set_bounds_type(item, change.boundsType);
+                obs_sceneitem_set_bounds(item, &change.bounds);
+            }
+        }
+        if (update->order.isEmpty())
+            return;
+
+        // Bottom first, as libobs stores them
+        struct Items {
+            QVector<obs_sceneitem_t *> items;
+            QStringList names;
+        } current;
+        obs_scene_enum_items(scene, [](obs_scene_t *, obs_sceneitem_t *item, void *param) {
+            auto *current = static_cast<Items *>(param);
+            obs_source_t *source = obs_sceneitem_get_source(item);
+            const char *name = source ? obs_source_get_name(source) : nullptr;
+            current->items.push_back(item);
+            current->names << QString::fromUtf8(name ? name : "");
+            return true;
+        }, &current);
+
+        // Nothing to do when the order is already right
+        const QVector<int> order = computeSceneOrder(current.names, update->order);
+        if (order.isEmpty())
+            return;
+
+        // Top‑level items only: obs_scene_reorder_items2() would rebuild
+        // every group from the entries naming it, dropping the children
+        // of any group, whereas this leaves groups' contents alone
+        QVector<obs_sceneitem_t *> items;
+        items.reserve(order.size());
+        for (int index : order)
+            items.push_back(current.items.at(index));
+        obs_scene_reorder_items(scene, items.data(), size_t(items.size()));
+    }, &update);
+    return true;
 }
 
 obs_scene_t *ObsIntegration::getScene(const QString &sceneName)
 {
-    obs_source_t *source = obs_get_source_by_name(sceneName.toUtf8().constData());
-    if (!source)
-        return nullptr;
-    obs_scene_t *scene = obs_scene_from_source(source);
-    obs_source_release(source);
-    return scene;
+    return m_handles.scene(sceneName);
 }
 
 obs_sceneitem_t *ObsIntegration::findSceneItem(obs_scene_t *scene, const QString &sourceName)
 {
+    // Resolved by name once, then served from the handle cache
+    return m_handles.item(scene, sourceName);
+}
+
+bool ObsIntegration::addPreloadedImage(const QString &sceneName, const QString &sourceName,
+                                       const QString &filePath, bool autoStretch)
+{
+    obs_scene_t *scene = getScene(sceneName);
     if (!scene)
-        return nullptr;
-    // The obs_scene_find_source function returns the scene item associated
-    // with a source if present, otherwise nullptr.  In the current OBS API
-    // it takes a source name string.
-    obs_sceneitem_t *item = obs_scene_find_source(scene, sourceName.toUtf8().constData());
-    return item;
+        return false;
+    
+    obs_data_t *settings = obs_data_create();
+    obs_data_set_string(settings, "file", filePath.toUtf8().constData());
+    // Keep the decoded image while hidden; that is the point of preloading
+    obs_data_set_bool(settings, "unload", false);
+    obs_source_t *image = obs_source_create("image_source", sourceName.toUtf8().constData(), settings, nullptr);
+    obs_data_release(settings);
+    if (!image) {
+        qWarning() << "[Velutan] Failed to create preloaded background" << sourceName;
+        return false;
+    }
+    
+    // Add and hide it under one scene lock, as OBS itself does when
+    // adding sources, so it is never rendered
+    struct Add {
+        obs_source_t *image;
+        bool autoStretch;
+        obs_sceneitem_t *item;
+    } add{image, autoStretch, nullptr};
+    obs_enter_graphics();
+    obs_scene_atomic_update(scene, [](void *data, obs_scene_t *scene) {
+        auto *add = static_cast<Add *>(data);
+        add->item = obs_scene_add(scene, add->image);
+        if (!add->item)
+            return;
+        obs_sceneitem_set_visible(add->item, false);
+        obs_video_info ovi;
+        if (add->autoStretch && obs_get_video_info(&ovi)) {
+            struct vec2 bounds;
+            bounds.x = (float)ovi.base_width;
+            bounds.y = (float)ovi.base_height;
+            obs_sceneitem_set_bounds_type(add->item, OBS_BOUNDS_STRETCH);
+            obs_sceneitem_set_bounds(add->item, &bounds);
+        }
+    }, &add);
+    obs_leave_graphics();
+    obs_source_release(image);
+    if (!add.item)
+        return false;
+    
+    SceneBatch batch;
+    batch.lower(sourceName);
+    apply(sceneName, batch);
+    return true;
+}
+
+void ObsIntegration::removeSource(const QString &sourceName)
+{
+    obs_source_t *source = m_handles.source(sourceName);
+    if (!source)
+        return;
+    obs_source_remove(source);
+    obs_source_release(source);
+}
+
+bool ObsIntegration::removeFromScene(const QString &sceneName, const QString &sourceName)
+{
+    obs_sceneitem_t *item = findSceneItem(getScene(sceneName), sourceName);
+    if (!item)
+        return false;
+    obs_sceneitem_remove(item);
+    return true;
 }
 
 void ObsIntegration::getCanvasSize(uint32_t &width, uint32_t &height)
@@ -283,49 +445,84 @@ void ObsIntegration::getCanvasSize(uint32_t &width, uint32_t &height)
 QString ObsIntegration::generateGridImage(uint32_t width, uint32_t height, int gridSize,
                                           const QString &color, int opacity)
 {
-    // Create a transparent image
-    QImage image(width, height, QImage::Format_ARGB32);
-    image.fill(Qt::transparent);
-    
-    // Setup painter
-    QPainter painter(&image);
-    painter.setRenderHint(QPainter::Antialiasing, false);  // Crisp lines
-    
     // Parse color and set opacity
     QColor gridColor(color);
     gridColor.setAlpha(opacity);
     
-    QPen pen(gridColor);
-    pen.setWidth(1);
-    painter.setPen(pen);
-    
-    // Draw vertical lines
-    for (uint32_t x = 0; x <= width; x += gridSize) {
-        painter.drawLine(x, 0, x, height);
-    }
+    // Rendered only when no image with these parameters is cached
+    QString gridPath = GridImageCache::instance().path(int(width), int(height), gridSize, gridColor);
+    if (gridPath.isEmpty())
+        return QString();
     
-    // Draw horizontal lines
-    for (uint32_t y = 0; y <= height; y += gridSize) {
-        painter.drawLine(0, y, width, y);
+    qDebug() << "[Velutan] Grid image:" << gridPath;
+    return gridPath;
+}
+
+bool ObsIntegration::ensureGrid(const QString &sceneName, int gridSize, const QString &color, int opacity,
+                                bool showInStream, SceneBatch *batch)
+{
+    if (!gridSourceAvailable()) {
+        uint32_t width, height;
+        getCanvasSize(width, height);
+        QString gridImagePath = generateGridImage(width, height, gridSize, color, opacity);
+        return !gridImagePath.isEmpty() && ensureGridOverlay(sceneName, gridImagePath, showInStream, batch);
     }
     
-    painter.end();
+    if (!ensureScene(sceneName))
+        return false;
+    obs_scene_t *scene = getScene(sceneName);
+    if (!scene)
+        return false;
     
-    // Save to temporary file
-    QString tempDir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
-    QString gridPath = tempDir + "/velutan_grid_overlay.png";
+    QColor gridColor(color);
+    obs_data_t *settings = obs_data_create();
+    obs_data_set_int(settings, VELUTAN_GRID_CELL_SIZE, gridSize);
+    obs_data_set_int(settings, VELUTAN_GRID_COLOR,
+                     0xFF000000u | (uint32_t(gridColor.blue()) << 16) | (uint32_t(gridColor.green()) << 8)
+                             | uint32_t(gridColor.red()));
+    obs_data_set_int(settings, VELUTAN_GRID_OPACITY, opacity);
     
-    if (!image.save(gridPath, "PNG")) {
-        qWarning() << "[Velutan] Failed to save grid image to" << gridPath;
-        return QString();
+    obs_source_t *existing = m_handles.source(kGridSourceName);
+    if (existing && strcmp(obs_source_get_id(existing), VELUTAN_GRID_SOURCE_ID) != 0) {
+        // An image based grid from before the grid source existed
+        obs_source_remove(existing);
+        obs_source_release(existing);
+        existing = nullptr;
+    }
+    if (existing) {
+        // Settings change only; nothing is redrawn up front.  Unchanged
+        // settings (the grid being switched back on) skip the update.
+        obs_data_t *current = obs_source_get_settings(existing);
+        const bool changed = obs_data_get_int(current, VELUTAN_GRID_CELL_SIZE) != gridSize
+                             || obs_data_get_int(current, VELUTAN_GRID_COLOR)
+                                        != obs_data_get_int(settings, VELUTAN_GRID_COLOR)
+                             || obs_data_get_int(current, VELUTAN_GRID_OPACITY) != opacity;
+        obs_data_release(current);
+        if (changed)
+            obs_source_update(existing, settings);
+        obs_data_release(settings);
+        if (!findSceneItem(scene, kGridSourceName) && !obs_scene_add(scene, existing)) {
+            obs_source_release(existing);
+            return false;
+        }
+        obs_source_release(existing);
+        return true;
     }
     
-    qDebug() << "[Velutan] Grid image generated:" << gridPath;
-    return gridPath;
+    obs_source_t *grid = obs_source_create(VELUTAN_GRID_SOURCE_ID, kGridSourceName, settings, nullptr);
+    obs_data_release(settings);
+    if (!grid) {
+        qWarning() << "[Velutan] Failed to create grid overlay source";
+        return false;
+    }
+    // Added on top; canvas sized, so no bounds are needed
+    obs_sceneitem_t *item = obs_scene_add(scene, grid);
+    obs_source_release(grid);
+    return item != nullptr;
 }
 
 bool ObsIntegration::ensureGridOverlay(const QString &sceneName, const QString &gridImagePath,
-                                       bool showInStream)
+                                       bool showInStream, SceneBatch *batch)
 {
     Q_UNUSED(showInStream);  // For future implementation with private sources
     
@@ -336,25 +533,34 @@ bool ObsIntegration::ensureGridOverlay(const QString &sceneName, const QString &
     if (!scene)
         return false;
     
-    QString gridSourceName = "Velutan_Grid_Overlay";
+    const QString gridSourceName = kGridSourceName;
     
     // Check if grid source already exists
-    obs_source_t *existing = obs_get_source_by_name(gridSourceName.toUtf8().constData());
+    obs_source_t *existing = m_handles.source(gridSourceName);
     
     if (existing) {
-        // Update the image path
+        // Update the image path.  The cache returns the same path for an
+        // unchanged grid, and image_source reloads its file on every
+        // update, so that case is left alone.
         obs_data_t *settings = obs_source_get_settings(existing);
-        obs_data_set_string(settings, "file", gridImagePath.toUtf8().constData());
-        obs_source_update(existing, settings);
+        const QByteArray file = gridImagePath.toUtf8();
+        if (strcmp(obs_data_get_string(settings, "file"), file.constData()) != 0) {
+            obs_data_set_string(settings, "file", file.constData());
+            obs_source_update(existing, settings);
+        }
         obs_data_release(settings);
         
         // Ensure it's in the scene
-        obs_sceneitem_t *item = obs_scene_find_source(scene, gridSourceName.toUtf8().constData());
+        obs_sceneitem_t *item = findSceneItem(scene, gridSourceName);
         if (!item) {
             item = obs_scene_add(scene, existing);
             if (item) {
-                // Move to top (above everything except pinned sources)
-                obs_sceneitem_set_order(item, OBS_ORDER_MOVE_TOP);
+                // Move to top (above everything except pinned sources),
+                // with the batch's reorder when there is one
+                if (batch)
+                    batch->raise(gridSourceName);
+                else
+                    obs_sceneitem_set_order(item, OBS_ORDER_MOVE_TOP);
                 
                 // Make it fullscreen
                 obs_video_info ovi;
@@ -389,7 +595,10 @@ bool ObsIntegration::ensureGridOverlay(const QString &sceneName, const QString &
     obs_sceneitem_t *item = obs_scene_add(scene, gridSource);
     if (item) {
         // Move to top
-        obs_sceneitem_set_order(item, OBS_ORDER_MOVE_TOP);
+        if (batch)
+            batch->raise(gridSourceName);
+        else
+            obs_sceneitem_set_order(item, OBS_ORDER_MOVE_TOP);
         
         // Make it fullscreen
         obs_video_info ovi;
@@ -408,27 +617,24 @@ bool ObsIntegration::ensureGridOverlay(const QString &sceneName, const QString &
     return true;
 }
 
-void ObsIntegration::toggleGridOverlay(const QString &sceneName, bool visible)
+void ObsIntegration::toggleGridOverlay(const QString &sceneName, bool visible, SceneBatch *batch)
 {
-    obs_scene_t *scene = getScene(sceneName);
-    if (!scene)
-        return;
-    
-    QString gridSourceName = "Velutan_Grid_Overlay";
-    obs_sceneitem_t *item = findSceneItem(scene, gridSourceName);
-    
-    if (item) {
-        obs_sceneitem_set_visible(item, visible);
-        
-        if (visible) {
-            // Ensure it's on top when made visible
-            obs_sceneitem_set_order(item, OBS_ORDER_MOVE_TOP);
-        }
+    const QString gridSourceName = kGridSourceName;
+    SceneBatch own;
+    SceneBatch &changes = batch ? *batch : own;
+    changes.setVisible(gridSourceName, visible);
+    if (visible) {
+        // Ensure it's on top when made visible
+        changes.raise(gridSourceName);
     }
+    if (!batch)
+        apply(sceneName, own);
 }
 
 void ObsIntegration::snapSourceToGrid(const QString &sceneName, const QString &sourceName, int gridSize)
 {
+    if (gridSize <= 0)
+        return;
     obs_scene_t *scene = getScene(sceneName);
     if (!scene)
         return;
@@ -437,14 +643,74 @@ void ObsIntegration::snapSourceToGrid(const QString &sceneName, const QString &s
     if (!item)
         return;
     
-    // Get current position
+    // Snap to nearest grid point
     struct vec2 pos;
     obs_sceneitem_get_pos(item, &pos);
-    
-    // Snap to nearest grid point
-    pos.x = round(pos.x / gridSize) * gridSize;
-    pos.y = round(pos.y / gridSize) * gridSize;
-    
-    // Set snapped position
+    pos = snappedToGrid(pos, gridSize);
     obs_sceneitem_set_pos(item, &pos);
-}
\ No newline at end of file
+}
+
+int ObsIntegration::snapAllToGrid(const QString &sceneName, const GridSnapOptions &options)
+{
+    if (options.gridSize <= 0)
+        return 0;
+    obs_scene_t *scene = getScene(sceneName);
+    if (!scene)
+        return 0;
+
+    struct Snap {
+        const GridSnapOptions *options = nullptr;
+        QSet<QString> skip;
+        int changed = 0;
+    } snap;
+    snap.options = &options;
+    snap.skip = QSet<QString>(options.skip.begin(), options.skip.end());
+    snap.skip.insert(kGridSourceName);
+
+    // The items are read and moved under one scene lock, so hundreds of
+    // them cost one walk of the scene and one update
+    obs_scene_atomic_update(scene, [](void *data, obs_scene_t *scene) {
+        obs_scene_enum_items(scene, [](obs_scene_t *, obs_sceneitem_t *item, void *param) {
+            auto *snap = static_cast<Snap *>(param);
+            const GridSnapOptions &options = *snap->options;
+            if (obs_sceneitem_locked(item))
+                return true;
+            obs_source_t *source = obs_sceneitem_get_source(item);
+            const char *rawName = source ? obs_source_get_name(source) : nullptr;
+            if (!rawName)
+                return true;
+            const QString name = QString::fromUtf8(rawName);
+            if (snap->skip.contains(name)
+                || (!options.prefix.isEmpty() && !name.startsWith(options.prefix))
+                || (!options.sources.isEmpty() && !options.sources.contains(name)))
+                return true;
+
+            const int grid = options.gridSize;
+            bool changed = false;
+            vec2 pos;
+            obs_sceneitem_get_pos(item, &pos);
+            const vec2 snapped = snappedToGrid(pos, grid);
+            if (snapped.x != pos.x || snapped.y != pos.y) {
+                obs_sceneitem_set_pos(item, &snapped);
+                changed = true;
+            }
+
+            // Bounds become whole cells, never less than one
+            if (options.snapBounds && obs_sceneitem_get_bounds_type(item) != OBS_BOUNDS_NONE) {
+                vec2 bounds;
+                obs_sceneitem_get_bounds(item, &bounds);
+                vec2 rounded;
+                rounded.x = std::max(1.0f, roundf(bounds.x / grid)) * grid;
+                rounded.y = std::max(1.0f, roundf(bounds.y / grid)) * grid;
+                if (rounded.x != bounds.x || rounded.y != bounds.y) {
+                    obs_sceneitem_set_bounds(item, &rounded);
+                    changed = true;
+                }
+            }
+            if (changed)
+                ++snap->changed;
+            return true;
+        }, data);
+    }, &snap);
+    return snap.changed;
+}
@@ -1,7 +1,14 @@
 #pragma once
 
+#include <QHash>
 #include <QObject>
+#include <QSet>
 #include <QString>
+#include <QStringList>
+
+#include "scene_batch.hpp"
+#include "scene_mirror.hpp"
+#include "source_cache.hpp"
 
 /*
  * obs_integration.hpp
@@ -19,6 +26,15 @@ extern "C" {
 #include <obs-frontend-api.h>
 }
 
+/** Which items ObsIntegration::snapAllToGrid() moves, and how. */
+struct GridSnapOptions {
+    int gridSize = 50;
+    QString prefix;           // Only sources named with this prefix, if set
+    QSet<QString> sources;    // Only these sources, if not empty
+    QStringList skip;         // Never these sources, e.g. the pinned ones
+    bool snapBounds = false;  // Also round bounded items' bounds to whole cells
+};
+
 class ObsIntegration : public QObject
 {
     Q_OBJECT
@@ -44,8 +60,10 @@ public:
     /** Ensure that a character image source exists in the specified
      * scene.  If the source is not present it will be created with the
      * provided file path and made visible; otherwise its file will be
-     * updated and it will be unhidden. */
-    bool ensureCharacter(const QString &sceneName, const QString &sourceName, const QString &filePath);
+     * updated and it will be unhidden and raised.  With a batch, those
+     * updates are added to it instead of being applied immediately. */
+    bool ensureCharacter(const QString &sceneName, const QString &sourceName, const QString &filePath,
+                         SceneBatch *batch = nullptr);
 
     /** Toggle the visibility of the character image source.  The
      * source must reside in the given scene. */
@@ -60,32 +78,83 @@ public:
      * false. */
     bool isVisible(const QString &sceneName, const QString &sourceName) const;
     
+    /** Return the visibility, order and file of every item in the
+     * scene keyed by source name.  Served from the scene mirror, so a
+     * scene that has not changed since the last call costs no libobs
+     * calls.  Use this instead of calling isVisible() for many sources.
+     * Returns an empty map if the scene does not exist. */
+    QHash<QString, SceneItemState> sceneSnapshot(const QString &sceneName);
+    
     /** Bring pinned sources (e.g., Camera, Player) to the front of the
      * scene, ensuring they always stay on top regardless of other source
      * additions or changes. */
     void bringPinnedToFront(const QString &sceneName, const QStringList &pinnedSourceNames);
     
+    /** Apply a batch of item changes to the scene: visibility and
+     * transforms in one atomic update, ordering as a single reorder.
+     * Returns false if the scene does not exist. */
+    bool apply(const QString &sceneName, const SceneBatch &batch);
+    
+    /** Create an image source that stays decoded while hidden and add
+     * it to the bottom of the scene without ever showing it.  Used by
+     * BackgroundPool. */
+    bool addPreloadedImage(const QString &sceneName, const QString &sourceName,
+                           const QString &filePath, bool autoStretch);
+    
+    /** Remove a source from OBS altogether, including every scene. */
+    void removeSource(const QString &sourceName);
+    
+    /** Remove a source's item from one scene, leaving the source and
+     * any other scenes alone.  Returns false if there was no item. */
+    bool removeFromScene(const QString &sceneName, const QString &sourceName);
+    
     /** Get canvas (base) resolution from OBS */
     void getCanvasSize(uint32_t &width, uint32_t &height);
     
-    /** Generate a grid overlay image and save it to a temporary file.
-     * Returns the path to the generated image. */
+    /** Get a grid overlay image file from the grid image cache,
+     * generating it if needed (see grid_cache.hpp).  Returns the path to
+     * the image, or an empty string on failure. */
     QString generateGridImage(uint32_t width, uint32_t height, int gridSize, 
                               const QString &color, int opacity);
     
+    /** Ensure the grid overlay in the specified scene shows a grid with
+     * the given cell size, colour and opacity.  Uses the procedural grid
+     * source when it is available (see grid_source.hpp), replacing an
+     * image based grid, and falls back to generateGridImage() and
+     * ensureGridOverlay() otherwise.  With a batch, raising a newly
+     * added overlay is left to the batch's single reorder. */
+    bool ensureGrid(const QString &sceneName, int gridSize, const QString &color, int opacity,
+                    bool showInStream, SceneBatch *batch = nullptr);
+    
     /** Ensure that a grid overlay source exists in the specified scene.
      * If showInStream is false, the source will be on a separate layer
-     * that's only visible in OBS preview. */
+     * that's only visible in OBS preview.  A batch is used as by
+     * ensureGrid(). */
     bool ensureGridOverlay(const QString &sceneName, const QString &gridImagePath, 
-                           bool showInStream);
+                           bool showInStream, SceneBatch *batch = nullptr);
     
-    /** Toggle grid overlay visibility */
-    void toggleGridOverlay(const QString &sceneName, bool visible);
+    /** Toggle grid overlay visibility, raising it when shown.  With a
+     * batch the change is added to it instead of applied immediately. */
+    void toggleGridOverlay(const QString &sceneName, bool visible, SceneBatch *batch = nullptr);
     
     /** Snap a source to grid alignment */
     void snapSourceToGrid(const QString &sceneName, const QString &sourceName, int gridSize);
+    
+    /** Snap every matching item of a scene to the grid in one atomic
+     * update, walking the scene once instead of looking up each source.
+     * The grid overlay and locked items are left alone.  Returns the
+     * number of items moved or resized. */
+    int snapAllToGrid(const QString &sceneName, const GridSnapOptions &options);
+
+signals:
+    /** Items of a scene were added, removed, reordered, shown or hidden,
+     * whether by the plugin or elsewhere in OBS. */
+    void sceneChanged(const QString &sceneName);
 
 private:
     obs_scene_t *getScene(const QString &sceneName);
     obs_sceneitem_t *findSceneItem(obs_scene_t *scene, const QString &sourceName);
+
+    SceneMirror m_mirror;
+    SourceCache m_handles;  // Name → handle resolution for every method
 };
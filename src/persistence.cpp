@@ -1,4 +1,5 @@
 #include "persistence.hpp"
+#include "atomic_file.hpp"
 
 #include <QStandardPaths>
 #include <QDir>
@@ -8,7 +9,7 @@
 #include <QJsonArray>
 #include <QDebug>
 
-static QString configFilePath()
+QString configDirectory()
 {
     // Determine a writable location for our configuration.  The
     // AppConfigLocation typically resolves to something like
@@ -20,7 +21,17 @@ static QString configFilePath()
     if (!d.exists(dir)) {
         d.mkpath(dir);
     }
-    return dir + "/config.json";
+    return dir;
+}
+
+QString libraryFilePath()
+{
+    return configDirectory() + "/library.json";
+}
+
+static QString configFilePath()
+{
+    return configDirectory() + "/config.json";
 }
 
 PersistenceConfig loadConfig()
@@ -64,9 +75,19 @@ PersistenceConfig loadConfig()
     cfg.gridSize = obj.value("gridSize").toInt(cfg.gridSize);
     cfg.gridShowInStream = obj.value("gridShowInStream").toBool(cfg.gridShowInStream);
     cfg.gridSnapEnabled = obj.value("gridSnapEnabled").toBool(cfg.gridSnapEnabled);
+    cfg.gridSnapBounds = obj.value("gridSnapBounds").toBool(cfg.gridSnapBounds);
     cfg.gridColor = obj.value("gridColor").toString(cfg.gridColor);
     cfg.gridOpacity = obj.value("gridOpacity").toInt(cfg.gridOpacity);
     
+    cfg.thumbnailCacheMB = obj.value("thumbnailCacheMB").toInt(cfg.thumbnailCacheMB);
+    cfg.writeDurability = obj.value("writeDurability").toString(cfg.writeDurability);
+    cfg.backgroundPoolSize = obj.value("backgroundPoolSize").toInt(cfg.backgroundPoolSize);
+    cfg.backgroundPoolMB = obj.value("backgroundPoolMB").toInt(cfg.backgroundPoolMB);
+    for (const QJsonValue &val : obj.value("recentBackgrounds").toArray()) {
+        cfg.recentBackgrounds << val.toString();
+    }
+    cfg.shardedLibrary = obj.value("shardedLibrary").toBool(cfg.shardedLibrary);
+    
     return cfg;
 }
 
@@ -100,17 +121,24 @@ bool saveConfig(const PersistenceConfig &config)
     obj.insert("gridSize", config.gridSize);
     obj.insert("gridShowInStream", config.gridShowInStream);
     obj.insert("gridSnapEnabled", config.gridSnapEnabled);
+    obj.insert("gridSnapBounds", config.gridSnapBounds);
     obj.insert("gridColor", config.gridColor);
     obj.insert("gridOpacity", config.gridOpacity);
     
+    obj.insert("thumbnailCacheMB", config.thumbnailCacheMB);
+    obj.insert("writeDurability", config.writeDurability);
+    obj.insert("backgroundPoolSize", config.backgroundPoolSize);
+    obj.insert("backgroundPoolMB", config.backgroundPoolMB);
+    obj.insert("recentBackgrounds", QJsonArray::fromStringList(config.recentBackgrounds));
+    obj.insert("shardedLibrary", config.shardedLibrary);
+    
     QJsonDocument doc(obj);
     QString path = configFilePath();
-    QFile file(path);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    // Write to a temporary file and rename it over the old one, so a
+    // crash mid-write leaves the previous config intact
+    if (!writeFileAtomically(path, doc.toJson(QJsonDocument::Indented))) {
         qWarning() << "[Velutan] Could not write config file" << path;
         return false;
     }
-    file.write(doc.toJson(QJsonDocument::Indented));
-    file.close();
     return true;
 }
\ No newline at end of file
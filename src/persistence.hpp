@@ -30,10 +30,39 @@ struct PersistenceConfig {
     int gridSize = 50;  // Grid cell size in pixels
     bool gridShowInStream = false;  // Show grid in stream output (or only in preview)
     bool gridSnapEnabled = true;  // Snap sources to grid when moving
+    bool gridSnapBounds = false;  // "Snap All" also rounds bounds to whole cells
     QString gridColor = "#00FF00";  // Grid line color (green by default)
     int gridOpacity = 128;  // Grid opacity (0-255)
+    
+    // Memory budget for decoded thumbnails shared by all lists
+    int thumbnailCacheMB = 64;
+    
+    // How hard library and config writes are pushed to disk:
+    // "atomic", "synced" or "durable" (see atomic_file.hpp)
+    QString writeDurability = "synced";
+    
+    // Background preloading (see background_pool.hpp): how many hidden,
+    // decoded backgrounds to keep per scene (0 = off) and their budget
+    int backgroundPoolSize = 0;
+    int backgroundPoolMB = 512;
+    QStringList recentBackgrounds;  // Asset IDs, most recently set first
+    
+    // Keep the library as one file per theme plus a manifest and load
+    // it lazily (see library_shards.hpp) instead of one library.json
+    bool shardedLibrary = false;
 };
 
+/**
+ * Directory holding the plugin's configuration, library and caches.
+ * Created on first use.
+ */
+QString configDirectory();
+
+/**
+ * Path of the user's asset library (library.json) in configDirectory().
+ */
+QString libraryFilePath();
+
 /**
  * Load user configuration from disk.  If no configuration exists a
  * default configuration is returned.
@@ -41,6 +70,8 @@ struct PersistenceConfig {
 PersistenceConfig loadConfig();
 
 /**
- * Save user configuration to disk.  Returns true on success.
+ * Save user configuration to disk, replacing the file atomically.
+ * Returns true on success.  Safe to call from any thread; the dock
+ * goes through ConfigStore rather than calling this directly.
  */
 bool saveConfig(const PersistenceConfig &config);
@@ -0,0 +1,60 @@
+#include "scene_batch.hpp"
+
+void SceneBatch::setVisible(const QString &sourceName, bool visible)
+{
+    Change &change = changeFor(sourceName);
+    change.setVisible = true;
+    change.visible = visible;
+}
+
+void SceneBatch::setFile(const QString &sourceName, const QString &file)
+{
+    Change &change = changeFor(sourceName);
+    change.setFile = true;
+    change.file = file;
+}
+
+void SceneBatch::setPosition(const QString &sourceName, const vec2 &pos)
+{
+    Change &change = changeFor(sourceName);
+    change.setPosition = true;
+    change.position = pos;
+}
+
+void SceneBatch::setBounds(const QString &sourceName, obs_bounds_type type, const vec2 &bounds)
+{
+    Change &change = changeFor(sourceName);
+    change.setBounds = true;
+    change.boundsType = type;
+    change.bounds = bounds;
+}
+
+void SceneBatch::raise(const QString &sourceName)
+{
+    m_order.raised.removeAll(sourceName);
+    m_order.lowered.removeAll(sourceName);
+    m_order.raised << sourceName;
+}
+
+void SceneBatch::lower(const QString &sourceName)
+{
+    m_order.raised.removeAll(sourceName);
+    m_order.lowered.removeAll(sourceName);
+    m_order.lowered << sourceName;
+}
+
+void SceneBatch::keepOnTop(const QStringList &sourceNames)
+{
+    m_order.pinned = sourceNames;
+}
+
+SceneBatch::Change &SceneBatch::changeFor(const QString &sourceName)
+{
+    auto it = m_index.constFind(sourceName);
+    if (it != m_index.constEnd())
+        return m_changes[it.value()];
+    m_index.insert(sourceName, m_changes.size());
+    m_changes.push_back(Change());
+    m_changes.last().source = sourceName;
+    return m_changes.last();
+}
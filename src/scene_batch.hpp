@@ -0,0 +1,77 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "scene_order.hpp"
+
+/*
+ * scene_batch.hpp
+ *
+ * A set of changes to the items of one scene, collected first and then
+ * applied together by ObsIntegration::apply().  Every call to
+ * obs_sceneitem_set_order() and friends locks the scene and emits its
+ * own signal; a batch instead applies visibility and transform changes
+ * in a single obs_scene_atomic_update() and all ordering changes as one
+ * obs_scene_reorder_items(), so an action such as "show a character
+ * and keep the pinned sources on top" costs one reorder and one repaint
+ * rather than one per source.  The final order is computed by
+ * computeSceneOrder() (scene_order.hpp).
+ *
+ * Items are named by source.  Changes to sources that are not in the
+ * scene when the batch is applied are ignored.
+ */
+
+extern "C" {
+#include <obs.h>
+}
+
+class SceneBatch
+{
+public:
+    void setVisible(const QString &sourceName, bool visible);
+
+    /** Set the "file" setting of the item's source. */
+    void setFile(const QString &sourceName, const QString &file);
+
+    void setPosition(const QString &sourceName, const vec2 &pos);
+    void setBounds(const QString &sourceName, obs_bounds_type type, const vec2 &bounds);
+
+    /** Move an item to the top.  Items raised later end up above items
+     * raised earlier. */
+    void raise(const QString &sourceName);
+
+    /** Move an item to the bottom.  Items lowered later end up below
+     * items lowered earlier. */
+    void lower(const QString &sourceName);
+
+    /** Raise the given items above everything else, the first one
+     * topmost.  Used for pinned sources. */
+    void keepOnTop(const QStringList &sourceNames);
+
+    bool isEmpty() const { return m_changes.isEmpty() && m_order.isEmpty(); }
+
+private:
+    friend class ObsIntegration;
+
+    struct Change {
+        QString source;
+        bool setVisible = false;
+        bool visible = false;
+        bool setFile = false;
+        QString file;
+        bool setPosition = false;
+        vec2 position = {};
+        bool setBounds = false;
+        obs_bounds_type boundsType = OBS_BOUNDS_NONE;
+        vec2 bounds = {};
+    };
+
+    Change &changeFor(const QString &sourceName);
+
+    QVector<Change> m_changes;    // One per source, in first‑touched order
+    QHash<QString, int> m_index;  // Source name → m_changes row
+    SceneOrderRequest m_order;
+};
@@ -0,0 +1,319 @@
+#include "scene_mirror.hpp"
+
+#include <QMutexLocker>
+#include <utility>
+
+namespace {
+
+// Signals after which the item list or order is no longer trusted
+const char *const kStructureSignals[] = {"item_add", "item_remove", "reorder", "refresh"};
+
+// Signals after which the mirrored scene no longer answers to its name
+const char *const kGoneSignals[] = {"remove", "rename", "destroy"};
+
+struct Collected {
+    QHash<QString, SceneItemState> items;
+    QHash<int64_t, QString> namesById;
+};
+
+bool collectItem(obs_scene_t *, obs_sceneitem_t *item, void *param)
+{
+    auto *collected = static_cast<Collected *>(param);
+    obs_source_t *source = obs_sceneitem_get_source(item);
+    const char *name = source ? obs_source_get_name(source) : nullptr;
+    if (!name)
+        return true;
+
+    SceneItemState state;
+    state.visible = obs_sceneitem_visible(item);
+    state.order = collected->items.size();
+    obs_data_t *settings = obs_source_get_settings(source);
+    if (settings) {
+        state.file = QString::fromUtf8(obs_data_get_string(settings, "file"));
+        obs_data_release(settings);
+    }
+    const QString key = QString::fromUtf8(name);
+    collected->items.insert(key, state);
+    collected->namesById.insert(obs_sceneitem_get_id(item), key);
+    return true;
+}
+
+} // namespace
+
+struct SceneMirror::Scene {
+    QString name;
+    obs_scene_t *obsScene = nullptr;  // Identity only, never dereferenced
+    obs_weak_source_t *weak = nullptr;
+    QHash<QString, SceneItemState> items;
+    QHash<int64_t, QString> namesById;
+    bool stale = true;
+    bool syncing = false;
+    bool gone = false;
+    bool notifyPending = false;
+};
+
+SceneMirror::SceneMirror(QObject *parent)
+    : QObject(parent)
+{
+    obs_frontend_add_event_callback(onFrontendEvent, this);
+    // Settings changed from the properties dialog, a script or another
+    // plugin raise no scene signal; the global handler sees them all
+    signal_handler_connect(obs_get_signal_handler(), "source_update", onSourceUpdate, this);
+}
+
+SceneMirror::~SceneMirror()
+{
+    signal_handler_disconnect(obs_get_signal_handler(), "source_update", onSourceUpdate, this);
+    obs_frontend_remove_event_callback(onFrontendEvent, this);
+    clear();
+}
+
+QHash<QString, SceneItemState> SceneMirror::items(const QString &sceneName)
+{
+    Scene *scene = attach(sceneName);
+    if (!scene)
+        return QHash<QString, SceneItemState>();
+
+    bool stale;
+    {
+        QMutexLocker locker(&m_mutex);
+        stale = scene->stale;
+    }
+    if (stale && !resync(scene)) {
+        detach(scene);
+        return QHash<QString, SceneItemState>();
+    }
+    QMutexLocker locker(&m_mutex);
+    return scene->items;
+}
+
+void SceneMirror::noteFile(const QString &sourceName, const QString &file)
+{
+    QMutexLocker locker(&m_mutex);
+    applyFile(sourceName, file);
+}
+
+void SceneMirror::applyFile(const QString &sourceName, const QString &file)
+{
+    // Called with m_mutex held.  Walks m_byScene rather than m_scenes,
+    // which is only safe to touch on the GUI thread.
+    for (Scene *scene : std::as_const(m_byScene)) {
+        auto it = scene->items.find(sourceName);
+        if (it == scene->items.end() || it->file == file)
+            continue;
+        it->file = file;
+        notify(scene);
+    }
+}
+
+void SceneMirror::clear()
+{
+    while (!m_scenes.isEmpty())
+        detach(m_scenes.begin().value());
+}
+
+SceneMirror::Scene *SceneMirror::attach(const QString &sceneName)
+{
+    Scene *scene = m_scenes.value(sceneName);
+    if (scene) {
+        bool gone;
+        {
+            QMutexLocker locker(&m_mutex);
+            gone = scene->gone;
+        }
+        if (!gone)
+            return scene;
+        detach(scene);
+    }
+
+    obs_source_t *source = obs_get_source_by_name(sceneName.toUtf8().constData());
+    if (!source)
+        return nullptr;
+    obs_scene_t *obsScene = obs_scene_from_source(source);
+    if (!obsScene) {
+        obs_source_release(source);
+        return nullptr;
+    }
+
+    // A renamed scene, or a new one reusing a destroyed scene's address,
+    // may still have an entry under its old name.  Signal callbacks are
+    // looked up by scene, so that entry has to go first.
+    Scene *previous;
+    {
+        QMutexLocker locker(&m_mutex);
+        previous = m_byScene.value(obsScene);
+    }
+    if (previous)
+        detach(previous);
+
+    scene = new Scene;
+    scene->name = sceneName;
+    scene->obsScene = obsScene;
+    scene->weak = obs_source_get_weak_source(source);
+    {
+        QMutexLocker locker(&m_mutex);
+        m_byScene.insert(obsScene, scene);
+    }
+    m_scenes.insert(sceneName, scene);
+
+    // Connect before the first enumeration so nothing in between is missed
+    signal_handler_t *handler = obs_source_get_signal_handler(source);
+    for (const char *signal : kStructureSignals)
+        signal_handler_connect(handler, signal, onStructureChanged, this);
+    signal_handler_connect(handler, "item_visible", onItemVisible, this);
+    for (const char *signal : kGoneSignals)
+        signal_handler_connect(handler, signal, onSceneGone, this);
+    obs_source_release(source);
+    return scene;
+}
+
+void SceneMirror::detach(Scene *scene)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_byScene.value(scene->obsScene) == scene)
+            m_byScene.remove(scene->obsScene);
+    }
+    m_scenes.remove(scene->name);
+
+    // A destroyed scene took its signal handler with it
+    obs_source_t *source = obs_weak_source_get_source(scene->weak);
+    if (source) {
+        signal_handler_t *handler = obs_source_get_signal_handler(source);
+        for (const char *signal : kStructureSignals)
+            signal_handler_disconnect(handler, signal, onStructureChanged, this);
+        signal_handler_disconnect(handler, "item_visible", onItemVisible, this);
+        for (const char *signal : kGoneSignals)
+            signal_handler_disconnect(handler, signal, onSceneGone, this);
+        obs_source_release(source);
+    }
+    obs_weak_source_release(scene->weak);
+    delete scene;
+}
+
+bool SceneMirror::resync(Scene *scene)
+{
+    obs_source_t *source = obs_weak_source_get_source(scene->weak);
+    if (!source)
+        return false;
+
+    // Enumerate without holding the mutex; signals raised meanwhile
+    // mark the scene stale again so the next read picks them up
+    {
+        QMutexLocker locker(&m_mutex);
+        scene->stale = false;
+        scene->syncing = true;
+    }
+    Collected collected;
+    obs_scene_enum_items(obs_scene_from_source(source), collectItem, &collected);
+    obs_source_release(source);
+
+    QMutexLocker locker(&m_mutex);
+    scene->items = collected.items;
+    scene->namesById = collected.namesById;
+    scene->syncing = false;
+    return true;
+}
+
+void SceneMirror::notify(Scene *scene)
+{
+    // Called with m_mutex held, possibly off the GUI thread
+    if (scene->notifyPending)
+        return;
+    scene->notifyPending = true;
+    const QString name = scene->name;
+    QMetaObject::invokeMethod(this, [this, name]() {
+        {
+            QMutexLocker locker(&m_mutex);
+            Scene *scene = m_scenes.value(name);
+            if (scene)
+                scene->notifyPending = false;
+        }
+        emit sceneChanged(name);
+    }, Qt::QueuedConnection);
+}
+
+void SceneMirror::onStructureChanged(void *data, calldata_t *cd)
+{
+    auto *mirror = static_cast<SceneMirror *>(data);
+    auto *obsScene = static_cast<obs_scene_t *>(calldata_ptr(cd, "scene"));
+    QMutexLocker locker(&mirror->m_mutex);
+    Scene *scene = mirror->m_byScene.value(obsScene);
+    if (!scene)
+        return;
+    scene->stale = true;
+    mirror->notify(scene);
+}
+
+void SceneMirror::onItemVisible(void *data, calldata_t *cd)
+{
+    auto *mirror = static_cast<SceneMirror *>(data);
+    auto *obsScene = static_cast<obs_scene_t *>(calldata_ptr(cd, "scene"));
+    auto *item = static_cast<obs_sceneitem_t *>(calldata_ptr(cd, "item"));
+    const bool visible = calldata_bool(cd, "visible");
+    QMutexLocker locker(&mirror->m_mutex);
+    Scene *scene = mirror->m_byScene.value(obsScene);
+    if (!scene || !item)
+        return;
+
+    // Items the mirror has not seen yet, or a change racing with an
+    // enumeration, are left to the next resync
+    auto name = scene->namesById.constFind(obs_sceneitem_get_id(item));
+    if (scene->syncing || name == scene->namesById.constEnd()) {
+        scene->stale = true;
+    } else {
+        auto it = scene->items.find(*name);
+        if (it != scene->items.end())
+            it->visible = visible;
+    }
+    mirror->notify(scene);
+}
+
+void SceneMirror::onSceneGone(void *data, calldata_t *cd)
+{
+    auto *mirror = static_cast<SceneMirror *>(data);
+    auto *source = static_cast<obs_source_t *>(calldata_ptr(cd, "source"));
+    obs_scene_t *obsScene = source ? obs_scene_from_source(source) : nullptr;
+    QMutexLocker locker(&mirror->m_mutex);
+    Scene *scene = mirror->m_byScene.value(obsScene);
+    if (!scene)
+        return;
+    // Detaching happens on the GUI thread the next time the scene is read
+    scene->gone = true;
+    scene->stale = true;
+    mirror->notify(scene);
+}
+
+void SceneMirror::onSourceUpdate(void *data, calldata_t *cd)
+{
+    auto *mirror = static_cast<SceneMirror *>(data);
+    auto *source = static_cast<obs_source_t *>(calldata_ptr(cd, "source"));
+    const char *name = source ? obs_source_get_name(source) : nullptr;
+    if (!name)
+        return;
+
+    QString file;
+    obs_data_t *settings = obs_source_get_settings(source);
+    if (settings) {
+        file = QString::fromUtf8(obs_data_get_string(settings, "file"));
+        obs_data_release(settings);
+    }
+    QMutexLocker locker(&mirror->m_mutex);
+    mirror->applyFile(QString::fromUtf8(name), file);
+}
+
+void SceneMirror::onFrontendEvent(enum obs_frontend_event event, void *data)
+{
+    auto *mirror = static_cast<SceneMirror *>(data);
+    switch (event) {
+    case OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGING:
+    case OBS_FRONTEND_EVENT_SCENE_COLLECTION_CLEANUP:
+    case OBS_FRONTEND_EVENT_EXIT:
+        // Every scene is about to be torn down; scenes are tracked again
+        // lazily once the next collection is loaded
+        mirror->clear();
+        break;
+    default:
+        break;
+    }
+}
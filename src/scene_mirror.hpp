@@ -0,0 +1,83 @@
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+
+/*
+ * scene_mirror.hpp
+ *
+ * An in‑process mirror of the OBS scenes the plugin looks at.  For each
+ * tracked scene it keeps every item's source name, visibility, order
+ * and image file, and keeps them current from the scene's signals
+ * (item_add, item_remove, item_visible, reorder, refresh), the global
+ * source_update signal and frontend events, so that reading a scene's
+ * state normally costs no libobs calls at all.
+ *
+ * Visibility changes are applied to the mirror as they arrive.
+ * Structural changes (items added, removed or reordered) only mark the
+ * scene stale; it is enumerated again the next time it is read, once,
+ * however many changes came in.  A source whose settings are updated,
+ * by the plugin or from anywhere else, has its new file recorded in
+ * every tracked scene that shows it.  Signals may be raised on any
+ * thread, so the mirrored state is guarded by a mutex; tracking and
+ * reading must happen on the GUI thread.
+ */
+
+extern "C" {
+#include <obs.h>
+#include <obs-frontend-api.h>
+}
+
+/** State of one scene item as captured by the mirror. */
+struct SceneItemState {
+    bool visible = false;
+    int order = 0;  // Position in the scene, 0 = bottom
+    QString file;   // "file" setting of the item's source, if any
+};
+
+class SceneMirror : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SceneMirror(QObject *parent = nullptr);
+    ~SceneMirror();
+
+    /** Items of the named scene keyed by source name.  The scene is
+     * tracked from the first call on; returns an empty map if it does
+     * not exist. */
+    QHash<QString, SceneItemState> items(const QString &sceneName);
+
+    /** Record a new file for sourceName in every tracked scene that
+     * contains it.  Called by ObsIntegration right after it updates a
+     * source's file so the mirror does not wait for source_update. */
+    void noteFile(const QString &sourceName, const QString &file);
+
+    /** Stop tracking every scene. */
+    void clear();
+
+signals:
+    /** The mirrored state of sceneName changed.  Delivered on the GUI
+     * thread; a burst of changes results in a single emission. */
+    void sceneChanged(const QString &sceneName);
+
+private:
+    struct Scene;
+
+    Scene *attach(const QString &sceneName);
+    void detach(Scene *scene);
+    bool resync(Scene *scene);
+    void notify(Scene *scene);
+    void applyFile(const QString &sourceName, const QString &file);
+
+    static void onStructureChanged(void *data, calldata_t *cd);
+    static void onItemVisible(void *data, calldata_t *cd);
+    static void onSceneGone(void *data, calldata_t *cd);
+    static void onSourceUpdate(void *data, calldata_t *cd);
+    static void onFrontendEvent(enum obs_frontend_event event, void *data);
+
+    QHash<QString, Scene *> m_scenes;          // GUI thread only
+    QHash<obs_scene_t *, Scene *> m_byScene;   // Guarded by m_mutex
+    QMutex m_mutex;                            // Also guards each Scene's state
+};
@@ -0,0 +1,57 @@
+#include "scene_order.hpp"
+
+#include <QHash>
+#include <algorithm>
+
+namespace {
+
+enum Layer { Lowered, Content, Raised, Overlay, Pinned };
+
+struct Placement {
+    int layer = Content;
+    int rank = 0;
+};
+
+} // namespace
+
+QVector<int> computeSceneOrder(const QStringList &current, const SceneOrderRequest &request)
+{
+    if (current.isEmpty() || request.isEmpty())
+        return QVector<int>();
+
+    // Later entries win, so a pinned source that was also raised stays
+    // pinned and the overlay never drops into the content
+    QHash<QString, Placement> placements;
+    const int lowered = int(request.lowered.size());
+    for (int i = 0; i < lowered; ++i)
+        placements.insert(request.lowered.at(i), Placement{Lowered, lowered - 1 - i});
+    for (int i = 0; i < request.raised.size(); ++i)
+        placements.insert(request.raised.at(i), Placement{Raised, i});
+    if (!request.overlay.isEmpty())
+        placements.insert(request.overlay, Placement{Overlay, 0});
+    const int pinned = int(request.pinned.size());
+    for (int i = 0; i < pinned; ++i)
+        placements.insert(request.pinned.at(i), Placement{Pinned, pinned - 1 - i});
+
+    QVector<Placement> placed(current.size());
+    for (int i = 0; i < current.size(); ++i) {
+        auto it = placements.constFind(current.at(i));
+        placed[i] = it != placements.constEnd() ? it.value() : Placement{Content, i};
+    }
+
+    QVector<int> order(current.size());
+    for (int i = 0; i < order.size(); ++i)
+        order[i] = i;
+    // Stable, so items sharing a layer and rank keep their current order
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        if (placed[a].layer != placed[b].layer)
+            return placed[a].layer < placed[b].layer;
+        return placed[a].rank < placed[b].rank;
+    });
+
+    for (int i = 0; i < order.size(); ++i) {
+        if (order[i] != i)
+            return order;
+    }
+    return QVector<int>();
+}
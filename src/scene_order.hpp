@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/*
+ * scene_order.hpp
+ *
+ * Computes the final stacking order of a scene's items in one pass.
+ * Moving items one at a time (MOVE_TOP for the character just shown,
+ * then again for each pinned source) costs one reorder per move and
+ * briefly shows every intermediate order on stream.  Instead the whole
+ * target order is derived from the current one here and applied with a
+ * single reorder, or not at all when nothing would change.
+ *
+ * Layers, from the bottom:
+ *
+ *   lowered    items sent to the bottom, the last one lowered bottommost
+ *   content    everything else, in its current order
+ *   raised     items brought to the top, e.g. the character just
+ *              activated; the last one raised topmost
+ *   overlay    the grid overlay, above all content
+ *   pinned     pinned sources (camera, player), the first one topmost
+ *
+ * Orders are bottom‑first, as libobs stores them.  Pure functions with
+ * no libobs dependency.
+ */
+
+struct SceneOrderRequest {
+    QStringList lowered;
+    QStringList raised;
+    QString overlay;
+    QStringList pinned;
+
+    bool isEmpty() const { return lowered.isEmpty() && raised.isEmpty() && overlay.isEmpty() && pinned.isEmpty(); }
+};
+
+/**
+ * Compute the order of a scene whose items are currently named
+ * current (bottom first).  Returns a permutation: element i is the
+ * index into current of the item that ends up at position i.  Returns
+ * an empty vector if the current order already satisfies the request.
+ * Names not in the scene are ignored; several items showing the same
+ * source move together.
+ */
+QVector<int> computeSceneOrder(const QStringList &current, const SceneOrderRequest &request);
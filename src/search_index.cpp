@@ -0,0 +1,193 @@
+#include "search_index.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// Grams are three UTF‑16 code units packed into the low 48 bits of a key.
+constexpr int kGramLength = 3;
+
+inline quint64 gramAt(const QString &text, int pos)
+{
+    return (quint64(text.at(pos).unicode()) << 32)
+         | (quint64(text.at(pos + 1).unicode()) << 16)
+         | quint64(text.at(pos + 2).unicode());
+}
+
+} // namespace
+
+void SearchIndex::build(const QVector<Asset> &list, const StringTable &strings)
+{
+    clear();
+    m_grams.reserve(list.size());
+    for (const Asset &asset : list) {
+        append(asset, strings);
+    }
+}
+
+void SearchIndex::clear()
+{
+    m_grams.clear();
+    m_postings.clear();
+}
+
+void SearchIndex::append(const Asset &asset, const StringTable &strings)
+{
+    const int row = m_grams.size();
+    m_grams.push_back(gramsOf(asset, strings));
+    // Appending keeps every posting list sorted because row is the
+    // largest row number in the index.
+    addPostings(row, m_grams.last());
+}
+
+void SearchIndex::update(int row, const Asset &asset, const StringTable &strings)
+{
+    if (row < 0 || row >= m_grams.size())
+        return;
+    removePostings(row, m_grams[row]);
+    m_grams[row] = gramsOf(asset, strings);
+    addPostings(row, m_grams[row]);
+}
+
+void SearchIndex::remove(int row)
+{
+    remove(QVector<int>{row});
+}
+
+void SearchIndex::remove(QVector<int> rows)
+{
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    rows.erase(std::remove_if(rows.begin(), rows.end(),
+                              [this](int row) { return row < 0 || row >= m_grams.size(); }),
+               rows.end());
+    if (rows.isEmpty())
+        return;
+
+    for (int row : std::as_const(rows))
+        removePostings(row, m_grams[row]);
+    QVector<QVector<quint64>> kept;
+    kept.reserve(m_grams.size() - rows.size());
+    auto removed = rows.cbegin();
+    for (int row = 0; row < m_grams.size(); ++row) {
+        if (removed != rows.cend() && *removed == row)
+            ++removed;
+        else
+            kept.push_back(std::move(m_grams[row]));
+    }
+    m_grams.swap(kept);
+
+    // Renumber every remaining row in one pass: it moves down by the
+    // number of removed rows below it.  Posting lists are sorted, so
+    // that count only grows along each list.
+    for (auto it = m_postings.begin(); it != m_postings.end(); ++it) {
+        QVector<int> &postings = it.value();
+        auto first = std::upper_bound(postings.begin(), postings.end(), rows.first());
+        auto below = rows.cbegin();
+        for (auto r = first; r != postings.end(); ++r) {
+            while (below != rows.cend() && *below < *r)
+                ++below;
+            *r -= int(below - rows.cbegin());
+        }
+    }
+}
+
+QVector<int> SearchIndex::search(const QVector<Asset> &list, const StringTable &strings,
+                                 const QString &query) const
+{
+    QVector<int> result;
+    const QString q = query.trimmed().toLower();
+    if (q.isEmpty()) {
+        result.reserve(list.size());
+        for (int row = 0; row < list.size(); ++row)
+            result.push_back(row);
+        return result;
+    }
+
+    // Queries shorter than a gram cannot use the postings, and an index
+    // that has fallen out of step with its list cannot be trusted.  Both
+    // scan the pre‑folded fields instead, which is still allocation free.
+    if (q.size() < kGramLength || m_grams.size() != list.size()) {
+        for (int row = 0; row < list.size(); ++row) {
+            if (assetContains(list.at(row), strings, q))
+                result.push_back(row);
+        }
+        return result;
+    }
+
+    // Pick the rarest gram of the query as the candidate set.  Any row
+    // containing the query must contain all of its grams, so a missing
+    // gram means there are no matches at all.
+    const QVector<int> *candidates = nullptr;
+    for (int pos = 0; pos + kGramLength <= q.size(); ++pos) {
+        auto it = m_postings.constFind(gramAt(q, pos));
+        if (it == m_postings.constEnd())
+            return result;
+        if (!candidates || it.value().size() < candidates->size())
+            candidates = &it.value();
+    }
+
+    for (int row : *candidates) {
+        if (assetContains(list.at(row), strings, q))
+            result.push_back(row);
+    }
+    return result;
+}
+
+QVector<quint64> SearchIndex::gramsOf(const Asset &asset, const StringTable &strings)
+{
+    QVector<quint64> grams;
+    collectGrams(asset.foldedName, grams);
+    if (asset.themeId >= 0)
+        collectGrams(strings.folded(asset.themeId), grams);
+    for (const QString &tag : asset.tags)
+        collectGrams(strings.folded(tag), grams);
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    grams.squeeze();
+    return grams;
+}
+
+void SearchIndex::collectGrams(const QString &text, QVector<quint64> &out)
+{
+    for (int pos = 0; pos + kGramLength <= text.size(); ++pos)
+        out.push_back(gramAt(text, pos));
+}
+
+bool SearchIndex::assetContains(const Asset &asset, const StringTable &strings, const QString &needle)
+{
+    if (asset.foldedName.contains(needle))
+        return true;
+    if (asset.themeId >= 0 && strings.folded(asset.themeId).contains(needle))
+        return true;
+    for (const QString &tag : asset.tags) {
+        if (strings.folded(tag).contains(needle))
+            return true;
+    }
+    return false;
+}
+
+void SearchIndex::addPostings(int row, const QVector<quint64> &grams)
+{
+    for (quint64 gram : grams) {
+        QVector<int> &rows = m_postings[gram];
+        auto pos = std::lower_bound(rows.begin(), rows.end(), row);
+        rows.insert(pos, row);
+    }
+}
+
+void SearchIndex::removePostings(int row, const QVector<quint64> &grams)
+{
+    for (quint64 gram : grams) {
+        auto it = m_postings.find(gram);
+        if (it == m_postings.end())
+            continue;
+        QVector<int> &rows = it.value();
+        auto pos = std::lower_bound(rows.begin(), rows.end(), row);
+        if (pos != rows.end() && *pos == row)
+            rows.erase(pos);
+        if (rows.isEmpty())
+            m_postings.erase(it);
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "asset_library.hpp"
+
+/*
+ * search_index.hpp
+ *
+ * A persistent substring index over the searchable fields of a list of
+ * assets (name, theme and tags).  The index is built once when the
+ * library is loaded and then kept in step with the list it mirrors:
+ * row N of the index always describes element N of the asset vector.
+ *
+ * Every folded field is split into overlapping three‑character grams
+ * and each gram keeps a sorted posting list of the rows containing it.
+ * A query of three or more characters only has to look at the rows in
+ * the shortest posting list of its grams; every candidate is then
+ * verified with the same case‑insensitive contains() test used by
+ * AssetLibrary::search, so results are identical to the linear scan.
+ * The folded text itself is not copied: it is read from the assets'
+ * foldedName and the library's StringTable when verifying.
+ */
+
+class SearchIndex
+{
+public:
+    /** Rebuild the index from scratch for the given list. */
+    void build(const QVector<Asset> &list, const StringTable &strings);
+
+    /** Drop every entry. */
+    void clear();
+
+    /** Index an asset appended to the end of the mirrored list. */
+    void append(const Asset &asset, const StringTable &strings);
+
+    /** Re‑index the asset at the given row after it was edited. */
+    void update(int row, const Asset &asset, const StringTable &strings);
+
+    /** Remove the given row; later rows shift down by one, exactly as
+     * QVector::removeAt does on the mirrored list. */
+    void remove(int row);
+
+    /** Remove several rows at once, numbered as before any of them is
+     * removed.  Costs one renumbering pass over the postings however
+     * many rows go, where removing them one by one costs one each. */
+    void remove(QVector<int> rows);
+
+    /** Number of indexed rows. */
+    int size() const { return m_grams.size(); }
+
+    /**
+     * Return the rows of list whose name, theme or tags contain the
+     * query, ignoring case, in ascending order.  An empty query matches
+     * every row.  list and strings must be the ones the index was built
+     * from.
+     */
+    QVector<int> search(const QVector<Asset> &list, const StringTable &strings,
+                        const QString &query) const;
+
+private:
+    static QVector<quint64> gramsOf(const Asset &asset, const StringTable &strings);
+    static void collectGrams(const QString &text, QVector<quint64> &out);
+    static bool assetContains(const Asset &asset, const StringTable &strings, const QString &needle);
+
+    void addPostings(int row, const QVector<quint64> &grams);
+    void removePostings(int row, const QVector<quint64> &grams);
+
+    QVector<QVector<quint64>> m_grams;  // Sorted, unique grams per row
+    QHash<quint64, QVector<int>> m_postings;
+};
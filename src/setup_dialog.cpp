@@ -1,5 +1,10 @@
 #include "setup_dialog.hpp"
+#include "persistence.hpp"
+#include "library_saver.hpp"
+#include "library_shards.hpp"
 #include "theme_constants.hpp"
+#include "ui/ThumbnailCache.hpp"
+#include "ui/ThumbnailLoader.hpp"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -18,24 +23,13 @@
 #include <QCompleter>
 #include <QFormLayout>
 #include <QDialogButtonBox>
+#include <QIcon>
+#include <QPixmap>
 
 extern "C" {
 #include <obs-module.h>
 }
 
-static QString libraryFilePath()
-{
-    // Derive the library.json path from the app config location.  The
-    // same directory is used by persistence.cpp for storing
-    // configuration.
-    QString baseDir = QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation);
-    QString dir = baseDir + "/velutan-image-manager";
-    QDir d;
-    if (!d.exists(dir))
-        d.mkpath(dir);
-    return dir + "/library.json";
-}
-
 VelutanSetupDialog::VelutanSetupDialog(QWidget *parent)
     : QDialog(parent)
 {
@@ -43,7 +37,18 @@ VelutanSetupDialog::VelutanSetupDialog(QWidget *parent)
     resize(500, 400);
     auto *layout = new QVBoxLayout(this);
     m_listWidget = new QListWidget(this);
+    m_listWidget->setIconSize(QSize(40, 40));
     layout->addWidget(m_listWidget);
+    // Thumbnails come from the same cache the dock lists use
+    m_thumbnailLoader = new ThumbnailLoader(this);
+    connect(m_thumbnailLoader, &ThumbnailLoader::thumbnailReady, this, &VelutanSetupDialog::onThumbnailReady);
+    // Library writes happen in the background.  Connected before anyone
+    // else can connect to finished(), so the dock's reload on close
+    // always sees the last change; the flush also reports the last
+    // results before the dialog is deleted on close.
+    m_librarySaver = new LibrarySaver(this);
+    connect(m_librarySaver, &LibrarySaver::finished, this, &VelutanSetupDialog::onLibrarySaved);
+    connect(this, &QDialog::finished, m_librarySaver, &LibrarySaver::flush);
     auto *buttonRow = new QHBoxLayout();
     m_addBtn = new QPushButton(tr("Add Asset"), this);
     connect(m_addBtn, &QPushButton::clicked, this, &VelutanSetupDialog::onAddAsset);
@@ -59,10 +64,19 @@ VelutanSetupDialog::VelutanSetupDialog(QWidget *parent)
 
 void VelutanSetupDialog::loadLibrary()
 {
+    // The dialog lists every asset, so a sharded library is loaded whole
+    ShardedLibrary &shards = ShardedLibrary::instance();
+    shards.migrate();
+    if (ShardedLibrary::enabled() && shards.exists()) {
+        m_library = Library();
+        shards.loadAll(&m_library);
+        return;
+    }
     QString path = libraryFilePath();
     QFile f(path);
     if (f.exists()) {
         m_library = AssetLibrary::loadFromFile(path);
+        LibraryJournal::instance().replay(&m_library);
         return;
     }
     // Fallback to bundled library in plugin directory
@@ -73,15 +87,45 @@ void VelutanSetupDialog::loadLibrary()
 void VelutanSetupDialog::refreshList()
 {
     m_listWidget->clear();
+    m_itemsByFile.clear();
     for (const Asset &a : m_library.backgrounds) {
         QString themeInfo = a.theme.isEmpty() ? "" : QString(" [%1]").arg(a.theme);
         QString text = QString("[B] %1%2 (%3)").arg(a.name, themeInfo, a.tags.join(", "));
-        m_listWidget->addItem(text);
+        auto *item = new QListWidgetItem(text, m_listWidget);
+        setItemThumbnail(item, a.file);
     }
     for (const Asset &a : m_library.characters) {
         QString text = QString("[C] %1 (%2)").arg(a.name, a.tags.join(", "));
-        m_listWidget->addItem(text);
+        auto *item = new QListWidgetItem(text, m_listWidget);
+        setItemThumbnail(item, a.file);
+    }
+}
+
+void VelutanSetupDialog::setItemThumbnail(QListWidgetItem *item, const QString &file)
+{
+    const int scale = ThumbnailCache::preferredScale();
+    QPixmap thumbnail;
+    if (ThumbnailCache::instance().find(ThumbnailCache::keyFor(file, scale), &thumbnail)) {
+        if (!thumbnail.isNull())
+            item->setIcon(QIcon(thumbnail));
+        return;
     }
+    m_itemsByFile[file].append(item);
+    m_thumbnailLoader->request(file, QSize(76, 76), scale);
+}
+
+void VelutanSetupDialog::onThumbnailReady(const QString &file, const QImage &image)
+{
+    const QString key = ThumbnailCache::keyFor(file, ThumbnailCache::preferredScale());
+    const QList<QListWidgetItem *> items = m_itemsByFile.take(file);
+    if (image.isNull()) {
+        ThumbnailCache::instance().insertFailure(key, file);
+        return;
+    }
+    QPixmap thumbnail = QPixmap::fromImage(image);
+    ThumbnailCache::instance().insert(key, thumbnail);
+    for (QListWidgetItem *item : items)
+        item->setIcon(QIcon(thumbnail));
 }
 
 void VelutanSetupDialog::onAddAsset()
@@ -172,28 +216,39 @@ void VelutanSetupDialog::onAddAsset()
     asset.file = file;
     asset.tags = tags;
     asset.theme = theme;
+    AssetLibrary::internAsset(m_library, asset);
     
+    LibraryJournal::Category journalCategory;
     if (category == tr("Background")) {
         m_library.backgrounds.append(asset);
+        journalCategory = LibraryJournal::Category::Backgrounds;
     } else {
         m_library.characters.append(asset);
+        journalCategory = LibraryJournal::Category::Characters;
     }
     
-    // Auto-save after adding asset
-    QString userPath = libraryFilePath();
-    if (AssetLibrary::saveToFile(userPath, m_library)) {
-        emit libraryChanged();  // Notify dock widget
-    }
+    // Auto-save after adding asset; only the new asset is written.  The
+    // dock is notified once it is on disk.
+    m_librarySaver->record(LibraryJournal::Op::Add, journalCategory, asset, m_library);
     
     refreshList();
 }
 
 void VelutanSetupDialog::onSaveLibrary()
 {
-    QString path = libraryFilePath();
-    if (AssetLibrary::saveToFile(path, m_library)) {
+    // A write still running for an earlier add is not this save
+    m_confirmWrite = m_librarySaver->save(m_library);
+}
+
+void VelutanSetupDialog::onLibrarySaved(bool ok, quint64 write)
+{
+    const bool confirm = write == m_confirmWrite;
+    if (confirm)
+        m_confirmWrite = 0;
+    if (ok) {
         emit libraryChanged();  // Notify that library has changed
-        QMessageBox::information(this, tr("Saved"), tr("Library saved successfully."));
+        if (confirm)
+            QMessageBox::information(this, tr("Saved"), tr("Library saved successfully."));
     } else {
         QMessageBox::warning(this, tr("Error"), tr("Could not save library."));
     }
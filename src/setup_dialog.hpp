@@ -1,6 +1,9 @@
 #pragma once
 
 #include <QDialog>
+#include <QHash>
+#include <QImage>
+#include <QList>
 
 #include "asset_library.hpp"
 
@@ -15,7 +18,10 @@
  */
 
 class QListWidget;
+class QListWidgetItem;
 class QPushButton;
+class ThumbnailLoader;
+class LibrarySaver;
 
 class VelutanSetupDialog : public QDialog
 {
@@ -33,9 +39,16 @@ private slots:
 private:
     void loadLibrary();
     void refreshList();
+    void setItemThumbnail(QListWidgetItem *item, const QString &file);
+    void onThumbnailReady(const QString &file, const QImage &image);
+    void onLibrarySaved(bool ok, quint64 write);
 
     Library m_library;
     QListWidget *m_listWidget;
+    ThumbnailLoader *m_thumbnailLoader;
+    LibrarySaver *m_librarySaver;
+    quint64 m_confirmWrite = 0;  // Write carrying an explicit Save; report its result
+    QHash<QString, QList<QListWidgetItem *>> m_itemsByFile;  // Items waiting for a thumbnail
     QPushButton *m_addBtn;
     QPushButton *m_saveBtn;
 };
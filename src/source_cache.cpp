@@ -0,0 +1,208 @@
+#include "source_cache.hpp"
+
+#include <QMutexLocker>
+#include <utility>
+
+namespace {
+
+// Global signals after which a source no longer answers to its name
+const char *const kGoneSignals[] = {"source_remove", "source_destroy"};
+
+} // namespace
+
+SourceCache::SourceCache()
+{
+    signal_handler_t *handler = obs_get_signal_handler();
+    for (const char *signal : kGoneSignals)
+        signal_handler_connect(handler, signal, onSourceGone, this);
+    signal_handler_connect(handler, "source_rename", onSourceRenamed, this);
+    obs_frontend_add_event_callback(onFrontendEvent, this);
+}
+
+SourceCache::~SourceCache()
+{
+    obs_frontend_remove_event_callback(onFrontendEvent, this);
+    signal_handler_t *handler = obs_get_signal_handler();
+    for (const char *signal : kGoneSignals)
+        signal_handler_disconnect(handler, signal, onSourceGone, this);
+    signal_handler_disconnect(handler, "source_rename", onSourceRenamed, this);
+    clear();
+}
+
+obs_source_t *SourceCache::source(const QString &name)
+{
+    purgeStale();
+    auto it = m_sources.find(name);
+    if (it != m_sources.end()) {
+        obs_source_t *source = obs_weak_source_get_source(it.value());
+        if (source && !obs_source_removed(source)) {
+            ++m_stats.hits;
+            return source;
+        }
+        obs_source_release(source);
+        obs_weak_source_release(it.value());
+        m_sources.erase(it);
+        ++m_stats.invalidations;
+    }
+
+    ++m_stats.misses;
+    obs_source_t *source = obs_get_source_by_name(name.toUtf8().constData());
+    if (source)
+        m_sources.insert(name, obs_source_get_weak_source(source));
+    return source;
+}
+
+obs_scene_t *SourceCache::scene(const QString &name)
+{
+    obs_source_t *source = this->source(name);
+    if (!source)
+        return nullptr;
+    obs_scene_t *scene = obs_scene_from_source(source);
+    obs_source_release(source);
+    return scene;
+}
+
+obs_sceneitem_t *SourceCache::item(obs_scene_t *scene, const QString &sourceName)
+{
+    if (!scene)
+        return nullptr;
+    purgeStale();
+    const QPair<obs_scene_t *, QString> key(scene, sourceName);
+    auto it = m_items.constFind(key);
+    if (it != m_items.constEnd()) {
+        ++m_stats.hits;
+        return it.value();
+    }
+
+    ++m_stats.misses;
+    obs_sceneitem_t *item = obs_scene_find_source(scene, sourceName.toUtf8().constData());
+    if (item) {
+        watch(scene);
+        m_items.insert(key, item);
+    }
+    return item;
+}
+
+void SourceCache::clear()
+{
+    for (obs_weak_source_t *weak : std::as_const(m_sources))
+        obs_weak_source_release(weak);
+    m_sources.clear();
+    for (auto it = m_scenes.cbegin(); it != m_scenes.cend(); ++it)
+        unwatch(it.value());
+    m_scenes.clear();
+    m_items.clear();
+    QMutexLocker locker(&m_mutex);
+    m_stale.clear();
+    m_removedItems.clear();
+    m_goneScenes.clear();
+}
+
+void SourceCache::watch(obs_scene_t *scene)
+{
+    if (m_scenes.contains(scene))
+        return;
+    obs_source_t *source = obs_scene_get_source(scene);
+    signal_handler_connect(obs_source_get_signal_handler(source), "item_remove", onItemRemoved, this);
+    m_scenes.insert(scene, obs_source_get_weak_source(source));
+}
+
+void SourceCache::unwatch(obs_weak_source_t *weak)
+{
+    // A destroyed scene took its signal handler with it
+    obs_source_t *source = obs_weak_source_get_source(weak);
+    if (source) {
+        signal_handler_disconnect(obs_source_get_signal_handler(source), "item_remove",
+                                  onItemRemoved, this);
+        obs_source_release(source);
+    }
+    obs_weak_source_release(weak);
+}
+
+void SourceCache::purgeStale()
+{
+    QSet<QString> stale;
+    QSet<obs_sceneitem_t *> removedItems;
+    QSet<obs_scene_t *> goneScenes;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_stale.isEmpty() && m_removedItems.isEmpty() && m_goneScenes.isEmpty())
+            return;
+        stale.swap(m_stale);
+        removedItems.swap(m_removedItems);
+        goneScenes.swap(m_goneScenes);
+    }
+    for (const QString &name : std::as_const(stale)) {
+        auto it = m_sources.find(name);
+        if (it != m_sources.end()) {
+            obs_weak_source_release(it.value());
+            m_sources.erase(it);
+            ++m_stats.invalidations;
+        }
+    }
+    for (obs_scene_t *scene : std::as_const(goneScenes)) {
+        auto it = m_scenes.find(scene);
+        if (it != m_scenes.end()) {
+            unwatch(it.value());
+            m_scenes.erase(it);
+        }
+    }
+    // Items go with their source, their scene, or their own removal
+    for (auto it = m_items.begin(); it != m_items.end();) {
+        if (stale.contains(it.key().second) || goneScenes.contains(it.key().first)
+                || removedItems.contains(it.value())) {
+            it = m_items.erase(it);
+            ++m_stats.invalidations;
+        } else {
+            ++it;
+        }
+    }
+}
+
+void SourceCache::onSourceGone(void *data, calldata_t *cd)
+{
+    auto *self = static_cast<SourceCache *>(data);
+    obs_source_t *source = static_cast<obs_source_t *>(calldata_ptr(cd, "source"));
+    const char *name = source ? obs_source_get_name(source) : nullptr;
+    if (!name)
+        return;
+    obs_scene_t *scene = obs_scene_from_source(source);
+    QMutexLocker locker(&self->m_mutex);
+    self->m_stale.insert(QString::fromUtf8(name));
+    if (scene)
+        self->m_goneScenes.insert(scene);
+}
+
+void SourceCache::onItemRemoved(void *data, calldata_t *cd)
+{
+    auto *self = static_cast<SourceCache *>(data);
+    auto *item = static_cast<obs_sceneitem_t *>(calldata_ptr(cd, "item"));
+    if (!item)
+        return;
+    QMutexLocker locker(&self->m_mutex);
+    self->m_removedItems.insert(item);
+}
+
+void SourceCache::onSourceRenamed(void *data, calldata_t *cd)
+{
+    auto *self = static_cast<SourceCache *>(data);
+    const char *previous = calldata_string(cd, "prev_name");
+    if (!previous)
+        return;
+    QMutexLocker locker(&self->m_mutex);
+    self->m_stale.insert(QString::fromUtf8(previous));
+}
+
+void SourceCache::onFrontendEvent(enum obs_frontend_event event, void *data)
+{
+    // Unloading a collection releases its sources; do not hold them back
+    switch (event) {
+    case OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGING:
+    case OBS_FRONTEND_EVENT_SCENE_COLLECTION_CLEANUP:
+    case OBS_FRONTEND_EVENT_EXIT:
+        static_cast<SourceCache *>(data)->clear();
+        break;
+    default:
+        break;
+    }
+}
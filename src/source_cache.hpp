@@ -0,0 +1,86 @@
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QSet>
+#include <QString>
+
+/*
+ * source_cache.hpp
+ *
+ * Resolves source, scene and scene item names to libobs handles without
+ * a name lookup per call.  Sources are remembered as weak references
+ * and scene items as plain pointers, both keyed by name, so once a name
+ * has been resolved later calls cost a hash lookup instead of
+ * obs_get_source_by_name() / obs_scene_find_source() plus a UTF‑8
+ * conversion.  Nothing is kept alive by the cache: removing an item or
+ * a source frees it at once.
+ *
+ * Entries are dropped when OBS reports the source renamed, removed or
+ * destroyed (global source_rename, source_remove and source_destroy
+ * signals) and when the scene collection is unloaded.  Item pointers
+ * are not referenced, so every scene an item was cached from is watched
+ * for item_remove, and a removed item is dropped before its pointer
+ * could be handed out again.
+ *
+ * Lookups must happen on the GUI thread; the signals may arrive on any
+ * thread and only mark names, items and scenes stale, which the next
+ * lookup purges.
+ */
+
+extern "C" {
+#include <obs.h>
+#include <obs-frontend-api.h>
+}
+
+class SourceCache
+{
+public:
+    /** Lookup counters; hits are name lookups avoided. */
+    struct Stats {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 invalidations = 0;
+    };
+
+    SourceCache();
+    ~SourceCache();
+
+    /** New reference to the named source, or nullptr.  Release it with
+     * obs_source_release(). */
+    obs_source_t *source(const QString &name);
+
+    /** The named scene, or nullptr.  Not referenced, like the pointer
+     * returned by obs_scene_from_source(). */
+    obs_scene_t *scene(const QString &name);
+
+    /** The item showing sourceName in scene, or nullptr.  Not referenced. */
+    obs_sceneitem_t *item(obs_scene_t *scene, const QString &sourceName);
+
+    /** Forget every handle. */
+    void clear();
+
+    Stats stats() const { return m_stats; }
+
+private:
+    void purgeStale();
+    void watch(obs_scene_t *scene);
+    void unwatch(obs_weak_source_t *weak);
+
+    static void onSourceGone(void *data, calldata_t *cd);
+    static void onItemRemoved(void *data, calldata_t *cd);
+    static void onSourceRenamed(void *data, calldata_t *cd);
+    static void onFrontendEvent(enum obs_frontend_event event, void *data);
+
+    QHash<QString, obs_weak_source_t *> m_sources;
+    QHash<QPair<obs_scene_t *, QString>, obs_sceneitem_t *> m_items;
+    QHash<obs_scene_t *, obs_weak_source_t *> m_scenes;  // Scenes watched for item_remove
+    Stats m_stats;
+
+    // Changes since the last lookup, guarded by m_mutex
+    QMutex m_mutex;
+    QSet<QString> m_stale;                    // Source names gone
+    QSet<obs_sceneitem_t *> m_removedItems;   // Items removed from their scene
+    QSet<obs_scene_t *> m_goneScenes;         // Scenes removed or destroyed
+};
@@ -0,0 +1,190 @@
+#include "thumbnail_store.hpp"
+#include "persistence.hpp"
+
+#include <QBuffer>
+#include <QDataStream>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+const quint32 kPackMagic = 0x56544850;   // "VTHP"
+const quint32 kIndexMagic = 0x56544849;  // "VTHI"
+const quint32 kVersion = 1;
+const int kHeaderSize = 8;
+const int kStreamVersion = QDataStream::Qt_5_15;
+
+// Stale entries are never reclaimed individually; once the pack would
+// grow past this size it is simply started afresh.
+const qint64 kMaxPackSize = 512ll * 1024 * 1024;
+
+bool checkHeader(QFile &file, quint32 magic)
+{
+    if (file.size() == 0) {
+        QDataStream out(&file);
+        out.setVersion(kStreamVersion);
+        out << magic << kVersion;
+        return out.status() == QDataStream::Ok;
+    }
+    file.seek(0);
+    QDataStream in(&file);
+    in.setVersion(kStreamVersion);
+    quint32 fileMagic = 0, version = 0;
+    in >> fileMagic >> version;
+    return fileMagic == magic && version == kVersion;
+}
+
+} // namespace
+
+ThumbnailStore &ThumbnailStore::instance()
+{
+    static ThumbnailStore store(configDirectory());
+    return store;
+}
+
+ThumbnailStore::ThumbnailStore(const QString &directory)
+    : m_pack(directory + "/thumbnails.pack"), m_index(directory + "/thumbnails.idx")
+{
+    m_ok = open();
+    if (!m_ok) {
+        reset();
+        m_ok = open();
+    }
+    if (!m_ok)
+        qWarning() << "[Velutan] Thumbnail cache unavailable in" << directory;
+}
+
+bool ThumbnailStore::open()
+{
+    m_entries.clear();
+    if (!m_pack.open(QIODevice::ReadWrite) || !m_index.open(QIODevice::ReadWrite))
+        return false;
+    if (m_pack.size() > kMaxPackSize)
+        return false;
+    if (!checkHeader(m_pack, kPackMagic) || !checkHeader(m_index, kIndexMagic))
+        return false;
+
+    // Replay the index.  Later records for the same key win.  Replay
+    // stops at the first torn or corrupt record, or one pointing past the
+    // end of the pack (a crash between the two appends).
+    const qint64 packSize = m_pack.size();
+    qint64 indexEnd = kHeaderSize;
+    qint64 packEnd = kHeaderSize;
+    m_index.seek(kHeaderSize);
+    QDataStream in(&m_index);
+    in.setVersion(kStreamVersion);
+    while (!in.atEnd()) {
+        QString key;
+        qint64 offset;
+        qint32 length;
+        in >> key >> offset >> length;
+        if (in.status() != QDataStream::Ok)
+            break;
+        if (offset < kHeaderSize || length <= 0 || offset + length > packSize)
+            break;
+        m_entries.insert(key, Entry{offset, length});
+        indexEnd = m_index.pos();
+        packEnd = std::max(packEnd, offset + length);
+    }
+
+    // Cut both files back to the last good record, so that new records
+    // are appended where the next replay can reach them
+    if (m_index.size() > indexEnd && !m_index.resize(indexEnd))
+        return false;
+    if (m_pack.size() > packEnd && !m_pack.resize(packEnd))
+        return false;
+    return true;
+}
+
+void ThumbnailStore::reset()
+{
+    m_pack.close();
+    m_index.close();
+    m_pack.remove();
+    m_index.remove();
+    m_entries.clear();
+}
+
+QString ThumbnailStore::keyFor(const QString &file, int scale)
+{
+    QFileInfo info(file);
+    if (!info.exists())
+        return QString();
+    return QStringLiteral("%1|%2|%3|%4")
+        .arg(info.absoluteFilePath())
+        .arg(info.lastModified().toMSecsSinceEpoch())
+        .arg(info.size())
+        .arg(scale);
+}
+
+bool ThumbnailStore::load(const QString &file, int scale, QImage *image)
+{
+    const QString key = keyFor(file, scale);
+    if (key.isEmpty())
+        return false;
+
+    QByteArray data;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_ok)
+            return false;
+        auto it = m_entries.constFind(key);
+        if (it == m_entries.constEnd())
+            return false;
+        if (!m_pack.seek(it->offset))
+            return false;
+        data = m_pack.read(it->length);
+    }
+    // Decoding a small PNG is far cheaper than the source image and does
+    // not need the lock
+    if (!image->loadFromData(data, "PNG"))
+        return false;
+    image->setDevicePixelRatio(scale);
+    return true;
+}
+
+void ThumbnailStore::store(const QString &file, int scale, const QImage &image)
+{
+    const QString key = keyFor(file, scale);
+    if (key.isEmpty() || image.isNull())
+        return;
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    if (!image.save(&buffer, "PNG"))
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    if (!m_ok)
+        return;
+    if (m_pack.size() + data.size() > kMaxPackSize) {
+        // Full; start afresh rather than let a long session grow it
+        reset();
+        m_ok = open();
+        if (!m_ok)
+            return;
+    }
+    const qint64 offset = m_pack.size();
+    if (!m_pack.seek(offset) || m_pack.write(data) != data.size()) {
+        m_pack.resize(offset);
+        return;
+    }
+    m_pack.flush();
+
+    const qint64 indexEnd = m_index.size();
+    m_index.seek(indexEnd);
+    QDataStream out(&m_index);
+    out.setVersion(kStreamVersion);
+    out << key << offset << qint32(data.size());
+    if (out.status() != QDataStream::Ok || !m_index.flush()) {
+        // Never leave a partial record for later ones to follow
+        m_index.resize(indexEnd);
+        m_pack.resize(offset);
+        return;
+    }
+    m_entries.insert(key, Entry{offset, qint32(data.size())});
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QFile>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QString>
+
+/*
+ * thumbnail_store.hpp
+ *
+ * A persistent cache of pre‑scaled asset thumbnails kept next to
+ * library.json in the plugin's configuration directory.  Thumbnails are
+ * keyed by the source file's path, modification time and size plus the
+ * device pixel ratio they were rendered for (1x or 2x), so an edited
+ * image is simply looked up under a new key.
+ *
+ * Everything lives in two files rather than one file per thumbnail:
+ * thumbnails.pack holds the PNG‑encoded images back to back and
+ * thumbnails.idx is an append‑only index of key → (offset, length)
+ * records.  Both are only ever appended to.  On open, both files are cut
+ * back to the last complete record, so a crash loses at most the entries
+ * that were being written and later entries are appended where they can
+ * be read again.  Past 512 MB the pack is started afresh.
+ *
+ * The store is shared by every thumbnail worker and is safe to use from
+ * any thread.
+ */
+
+class ThumbnailStore
+{
+public:
+    /** The process‑wide store in the plugin's config directory. */
+    static ThumbnailStore &instance();
+
+    /** Look up a cached thumbnail for file at the given scale.  Returns
+     * false if none is stored for the file's current mtime and size. */
+    bool load(const QString &file, int scale, QImage *image);
+
+    /** Store a thumbnail for file at the given scale. */
+    void store(const QString &file, int scale, const QImage &image);
+
+private:
+    explicit ThumbnailStore(const QString &directory);
+
+    struct Entry {
+        qint64 offset;
+        qint32 length;
+    };
+
+    static QString keyFor(const QString &file, int scale);
+    bool open();
+    void reset();
+
+    QMutex m_mutex;
+    QFile m_pack;
+    QFile m_index;
+    QHash<QString, Entry> m_entries;
+    bool m_ok = false;
+};
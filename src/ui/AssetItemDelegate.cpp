@@ -0,0 +1,276 @@
+#include "AssetItemDelegate.hpp"
+#include "AssetListModel.hpp"
+
+#include <QAbstractItemView>
+#include <QFontMetrics>
+#include <QHelpEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPixmap>
+#include <QToolTip>
+
+extern "C" {
+#include <obs-module.h>
+}
+
+namespace {
+
+constexpr int kRowHeight = 104;
+constexpr int kThumbnailSize = 80;
+constexpr int kSpacing = 12;
+
+QRect cardRect(const QRect &rowRect)
+{
+    return rowRect.adjusted(4, 3, -4, -3);
+}
+
+} // namespace
+
+AssetItemDelegate::AssetItemDelegate(bool backgrounds, QObject *parent)
+    : QStyledItemDelegate(parent), m_isBackgroundList(backgrounds)
+{
+    m_buttonFont.setPixelSize(10);
+    m_buttonFont.setWeight(QFont::Medium);
+
+    // Same palette the per-row QPushButton stylesheets used
+    const Button editBtn{QStringLiteral("edit"), QStringLiteral("✏"), QStringLiteral("Edit asset details"),
+                         QColor("#007ACC"), QColor("#005FA3"), QColor("#004578"), 32, 10};
+    const Button deleteBtn{QStringLiteral("delete"), QStringLiteral("🗑"), QStringLiteral("Delete from library"),
+                           QColor("#DC3545"), QColor("#C82333"), QColor("#BD2130"), 32, 10};
+
+    if (m_isBackgroundList) {
+        // Backgrounds: set, edit, and delete buttons
+        m_inactiveButtons = {
+            {QStringLiteral("set"), QStringLiteral("Set"), QString(),
+             QColor("#28A745"), QColor("#218838"), QColor("#1E7E34"), 80, 12},
+            editBtn, deleteBtn};
+        m_activeButtons = {
+            {QStringLiteral("set"), QStringLiteral("✓ Active"), QString(),
+             QColor("#28A745"), QColor("#218838"), QColor("#1E7E34"), 60, 12},
+            editBtn, deleteBtn};
+    } else {
+        // Characters: toggle, edit and delete; active characters also get
+        // "Bring to Front" and "Remove from Scene"
+        m_inactiveButtons = {
+            {QStringLiteral("toggle"), "👤 " + QString(obs_module_text("Show")), QString(),
+             QColor("#28A745"), QColor("#218838"), QColor("#1E7E34"), 80, 12},
+            editBtn, deleteBtn};
+        m_activeButtons = {
+            {QStringLiteral("toggle"), "👁 " + QString(obs_module_text("Hide")), QString(),
+             QColor("#FF8C00"), QColor("#FF7700"), QColor("#E67300"), 80, 12},
+            editBtn,
+            {QStringLiteral("front"), "⬆ " + QString(obs_module_text("Front")), QString(),
+             QColor("#6C757D"), QColor("#5A6268"), QColor("#545B62"), 60, 12},
+            {QStringLiteral("remove"), QStringLiteral("❌"), QStringLiteral("Remove from scene"),
+             QColor("#FFC107"), QColor("#E0A800"), QColor("#D39E00"), 32, 10},
+            deleteBtn};
+    }
+}
+
+const QVector<AssetItemDelegate::Button> &AssetItemDelegate::buttonsFor(bool active) const
+{
+    return active ? m_activeButtons : m_inactiveButtons;
+}
+
+QVector<QRect> AssetItemDelegate::buttonRects(const QStyleOptionViewItem &option,
+                                              const QVector<Button> &buttons) const
+{
+    // Lay the buttons out right to left, vertically centred in the card
+    QFontMetrics fm(m_buttonFont);
+    const QRect card = cardRect(option.rect);
+    const int height = fm.height() + 12;
+    const int top = card.center().y() - height / 2;
+    int right = card.right() - 8;
+
+    QVector<QRect> rects(buttons.size());
+    for (int i = buttons.size() - 1; i >= 0; --i) {
+        const Button &b = buttons[i];
+        int width = qMax(b.minWidth, fm.horizontalAdvance(b.text)) + 2 * b.horizontalPadding;
+        rects[i] = QRect(right - width + 1, top, width, height);
+        right -= width + kSpacing;
+    }
+    return rects;
+}
+
+int AssetItemDelegate::buttonAt(const QStyleOptionViewItem &option, const QModelIndex &index,
+                                const QPoint &pos) const
+{
+    const bool active = index.data(AssetListModel::ActiveRole).toBool();
+    const QVector<QRect> rects = buttonRects(option, buttonsFor(active));
+    for (int i = 0; i < rects.size(); ++i) {
+        if (rects[i].contains(pos))
+            return i;
+    }
+    return -1;
+}
+
+bool AssetItemDelegate::setHoveredButton(int row, int button)
+{
+    if (row == m_hoverRow && button == m_hoverButton)
+        return false;
+    m_hoverRow = row;
+    m_hoverButton = button;
+    return true;
+}
+
+void AssetItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option,
+                              const QModelIndex &index) const
+{
+    const bool active = index.data(AssetListModel::ActiveRole).toBool();
+    const bool hovered = option.state & QStyle::State_MouseOver;
+    const QRect card = cardRect(option.rect);
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing, true);
+
+    // Card background; active assets get the dark green treatment
+    QColor fill, border;
+    int borderWidth;
+    if (active) {
+        fill = hovered ? QColor("#1F4A1F") : QColor("#1A3A1A");
+        border = hovered ? QColor("#34D058") : QColor("#28A745");
+        borderWidth = 2;
+    } else {
+        fill = hovered ? QColor("#2D2D30") : QColor("#252526");
+        border = hovered ? QColor("#007ACC") : QColor("#3F3F46");
+        borderWidth = 1;
+    }
+    painter->setPen(QPen(border, borderWidth));
+    painter->setBrush(fill);
+    painter->drawRoundedRect(QRectF(card).adjusted(0.5, 0.5, -0.5, -0.5), 8, 8);
+
+    // Thumbnail frame
+    QRect thumbRect(card.left() + 8, card.center().y() - kThumbnailSize / 2,
+                    kThumbnailSize, kThumbnailSize);
+    painter->setPen(QPen(QColor("#3F3F46"), 2));
+    painter->setBrush(QColor("#1E1E1E"));
+    painter->drawRoundedRect(QRectF(thumbRect).adjusted(1, 1, -1, -1), 8, 8);
+
+    QPixmap thumbnail = index.data(AssetListModel::ThumbnailRole).value<QPixmap>();
+    if (!thumbnail.isNull()) {
+        QSize size = thumbnail.size() / thumbnail.devicePixelRatio();
+        QRect target(QPoint(0, 0), size);
+        target.moveCenter(thumbRect.center());
+        painter->drawPixmap(target, thumbnail);
+    } else {
+        QFont iconFont = option.font;
+        iconFont.setPixelSize(32);
+        painter->setFont(iconFont);
+        painter->setPen(Qt::white);
+        painter->drawText(thumbRect, Qt::AlignCenter, QStringLiteral("📷"));
+    }
+
+    // Buttons
+    const QVector<Button> &buttons = buttonsFor(active);
+    const QVector<QRect> rects = buttonRects(option, buttons);
+    painter->setFont(m_buttonFont);
+    for (int i = 0; i < buttons.size(); ++i) {
+        const Button &b = buttons[i];
+        QColor color = b.color;
+        if (index.row() == m_pressedRow && i == m_pressedButton)
+            color = b.pressedColor;
+        else if (index.row() == m_hoverRow && i == m_hoverButton)
+            color = b.hoverColor;
+        painter->setPen(Qt::NoPen);
+        painter->setBrush(color);
+        painter->drawRoundedRect(rects[i], 4, 4);
+        painter->setPen(Qt::white);
+        painter->drawText(rects[i], Qt::AlignCenter, b.text);
+    }
+
+    // Name, theme and tags between the thumbnail and the buttons
+    const int textLeft = thumbRect.right() + kSpacing;
+    const int textRight = (rects.isEmpty() ? card.right() - 8 : rects.first().left()) - kSpacing;
+    const int textWidth = qMax(0, textRight - textLeft);
+
+    QFont nameFont = option.font;
+    nameFont.setPixelSize(13);
+    nameFont.setWeight(QFont::DemiBold);
+    QFont themeFont = option.font;
+    themeFont.setPixelSize(10);
+    themeFont.setWeight(QFont::DemiBold);
+    QFont tagsFont = option.font;
+    tagsFont.setPixelSize(10);
+    tagsFont.setItalic(true);
+
+    struct Line { QString text; QFont font; QColor color; };
+    QVector<Line> lines;
+    lines.push_back({index.data(Qt::DisplayRole).toString(), nameFont, QColor("#FFFFFF")});
+    const QString theme = index.data(AssetListModel::ThemeRole).toString();
+    if (m_isBackgroundList && !theme.isEmpty())
+        lines.push_back({"🌍 " + theme, themeFont, QColor("#60A5FA")});
+    const QStringList tags = index.data(AssetListModel::TagsRole).toStringList();
+    if (!tags.isEmpty())
+        lines.push_back({"🏷 " + tags.join(", "), tagsFont, QColor("#9CA3AF")});
+
+    int blockHeight = 0;
+    for (const Line &line : lines)
+        blockHeight += QFontMetrics(line.font).height() + 2;
+    int y = card.center().y() - blockHeight / 2;
+    for (const Line &line : lines) {
+        QFontMetrics fm(line.font);
+        painter->setFont(line.font);
+        painter->setPen(line.color);
+        painter->drawText(QRect(textLeft, y, textWidth, fm.height()), Qt::AlignLeft | Qt::AlignVCenter,
+                          fm.elidedText(line.text, Qt::ElideRight, textWidth));
+        y += fm.height() + 2;
+    }
+
+    painter->restore();
+}
+
+QSize AssetItemDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    Q_UNUSED(index);
+    return QSize(option.rect.width(), kRowHeight);
+}
+
+bool AssetItemDelegate::editorEvent(QEvent *event, QAbstractItemModel *model,
+                                    const QStyleOptionViewItem &option, const QModelIndex &index)
+{
+    if (event->type() != QEvent::MouseButtonPress && event->type() != QEvent::MouseButtonRelease)
+        return QStyledItemDelegate::editorEvent(event, model, option, index);
+
+    auto *mouseEvent = static_cast<QMouseEvent *>(event);
+    if (mouseEvent->button() != Qt::LeftButton)
+        return false;
+
+    auto *view = qobject_cast<QAbstractItemView *>(const_cast<QWidget *>(option.widget));
+    const int button = buttonAt(option, index, mouseEvent->position().toPoint());
+
+    if (event->type() == QEvent::MouseButtonPress) {
+        m_pressedRow = button >= 0 ? index.row() : -1;
+        m_pressedButton = button;
+        if (view)
+            view->update(index);
+        return button >= 0;
+    }
+
+    // Release: only a click that started and ended on the same button
+    // counts, mirroring QPushButton
+    const bool clicked = button >= 0 && index.row() == m_pressedRow && button == m_pressedButton;
+    m_pressedRow = -1;
+    m_pressedButton = -1;
+    if (view)
+        view->update(index);
+    if (clicked) {
+        const bool active = index.data(AssetListModel::ActiveRole).toBool();
+        emit buttonClicked(index, buttonsFor(active).at(button).action);
+    }
+    return clicked;
+}
+
+bool AssetItemDelegate::helpEvent(QHelpEvent *event, QAbstractItemView *view,
+                                  const QStyleOptionViewItem &option, const QModelIndex &index)
+{
+    if (event->type() == QEvent::ToolTip && index.isValid()) {
+        const int button = buttonAt(option, index, event->pos());
+        const bool active = index.data(AssetListModel::ActiveRole).toBool();
+        if (button >= 0 && !buttonsFor(active).at(button).toolTip.isEmpty()) {
+            QToolTip::showText(event->globalPos(), buttonsFor(active).at(button).toolTip, view);
+            return true;
+        }
+        QToolTip::hideText();
+    }
+    return QStyledItemDelegate::helpEvent(event, view, option, index);
+}
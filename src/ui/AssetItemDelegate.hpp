@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QColor>
+#include <QFont>
+#include <QStyledItemDelegate>
+#include <QVector>
+
+/*
+ * AssetItemDelegate
+ *
+ * Paints one AssetListModel row as a card: thumbnail, name, theme,
+ * tags and the row's action buttons.  The buttons are not widgets; the
+ * delegate lays them out on demand and hit-tests mouse events against
+ * the same layout, emitting buttonClicked with the button's action
+ * string ("set", "edit", "delete", "toggle", "front" or "remove").
+ */
+
+class AssetItemDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+public:
+    explicit AssetItemDelegate(bool backgrounds, QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option,
+               const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    bool editorEvent(QEvent *event, QAbstractItemModel *model,
+                     const QStyleOptionViewItem &option, const QModelIndex &index) override;
+    bool helpEvent(QHelpEvent *event, QAbstractItemView *view,
+                   const QStyleOptionViewItem &option, const QModelIndex &index) override;
+
+    /** Index of the button under pos in the given row, or -1. */
+    int buttonAt(const QStyleOptionViewItem &option, const QModelIndex &index,
+                 const QPoint &pos) const;
+
+    /** Remember which button the mouse is over so it is painted with
+     * its hover colour.  Returns true if the hover state changed. */
+    bool setHoveredButton(int row, int button);
+
+signals:
+    void buttonClicked(const QModelIndex &index, const QString &action);
+
+private:
+    struct Button {
+        QString action;
+        QString text;
+        QString toolTip;
+        QColor color;
+        QColor hoverColor;
+        QColor pressedColor;
+        int minWidth;
+        int horizontalPadding;
+    };
+
+    const QVector<Button> &buttonsFor(bool active) const;
+    QVector<QRect> buttonRects(const QStyleOptionViewItem &option, const QVector<Button> &buttons) const;
+
+    bool m_isBackgroundList;
+    QVector<Button> m_inactiveButtons;
+    QVector<Button> m_activeButtons;
+    QFont m_buttonFont;
+
+    int m_hoverRow = -1;
+    int m_hoverButton = -1;
+    int m_pressedRow = -1;
+    int m_pressedButton = -1;
+};
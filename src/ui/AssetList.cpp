@@ -1,44 +1,49 @@
 #include "AssetList.hpp"
+#include "AssetListModel.hpp"
+#include "AssetItemDelegate.hpp"
 
-#include <QListWidget>
-#include <QListWidgetItem>
+#include <QListView>
 #include <QHBoxLayout>
-#include <QVBoxLayout>
-#include <QLabel>
-#include <QPushButton>
-#include <QToolButton>
-#include <QPixmap>
-#include <QFileInfo>
-
-extern "C" {
-#include <obs-module.h>
-}
+#include <QMouseEvent>
+#include <QScrollBar>
+#include <QStyleOptionViewItem>
+#include <QTimer>
 
 AssetList::AssetList(bool backgrounds, QWidget *parent)
     : QWidget(parent), m_isBackgroundList(backgrounds)
 {
-    m_listWidget = new QListWidget(this);
+    m_model = new AssetListModel(this);
+    m_delegate = new AssetItemDelegate(backgrounds, this);
+
+    m_listView = new QListView(this);
+    m_listView->setModel(m_model);
+    m_listView->setItemDelegate(m_delegate);
     auto *layout = new QHBoxLayout(this);
     layout->setContentsMargins(0, 0, 0, 0);
-    layout->addWidget(m_listWidget);
-    m_listWidget->setSelectionMode(QAbstractItemView::NoSelection);
-    m_listWidget->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
-    m_listWidget->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    
+    layout->addWidget(m_listView);
+    m_listView->setSelectionMode(QAbstractItemView::NoSelection);
+    m_listView->setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    m_listView->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    // Every row has the same height, which lets the view skip measuring
+    // rows it never shows
+    m_listView->setUniformItemSizes(true);
+    m_listView->setMouseTracking(true);
+    m_listView->viewport()->installEventFilter(this);
+
     // Modern list styling
-    m_listWidget->setStyleSheet(
-        "QListWidget { "
+    m_listView->setStyleSheet(
+        "QListView { "
         "   background-color: #1E1E1E; "
         "   border: 1px solid #3F3F46; "
         "   border-radius: 4px; "
         "   outline: none; "
         "}"
-        "QListWidget::item { "
-        "   border-bottom: 1px solid #2D2D30; "
-        "   padding: 4px; "
-        "}"
-        "QListWidget::item:hover { background-color: #2D2D30; }"
     );
+
+    connect(m_delegate, &AssetItemDelegate::buttonClicked, this, &AssetList::onButtonClicked);
+    // Withdraw thumbnail decodes for rows that scroll away before the
+    // workers get to them
+    connect(m_listView->verticalScrollBar(), &QScrollBar::valueChanged, this, &AssetList::updateVisibleRows);
 }
 
 void AssetList::setActiveAssets(const QStringList &activeNames)
@@ -49,55 +54,10 @@ void AssetList::setActiveAssets(const QStringList &activeNames)
 
 void AssetList::setAssets(const QVector<Asset> &assets)
 {
-    m_listWidget->clear();
-    
-    // Active button style (orange for active characters)
-    QString activeBtnStyle = 
-        "QPushButton { "
-        "   background-color: #FF8C00; "
-        "   border: none; "
-        "   border-radius: 4px; "
-        "   padding: 6px 12px; "
-        "   color: white; "
-        "   font-weight: 500; "
-        "   font-size: 10px; "
-        "   min-width: 80px; "
-        "}"
-        "QPushButton:hover { background-color: #FF7700; }"
-        "QPushButton:pressed { background-color: #E67300; }";
-    
-    // Primary button style (green for inactive)
-    QString primaryBtnStyle = 
-        "QPushButton { "
-        "   background-color: #28A745; "
-        "   border: none; "
-        "   border-radius: 4px; "
-        "   padding: 6px 12px; "
-        "   color: white; "
-        "   font-weight: 500; "
-        "   font-size: 10px; "
-        "   min-width: 80px; "
-        "}"
-        "QPushButton:hover { background-color: #218838; }"
-        "QPushButton:pressed { background-color: #1E7E34; }";
-    
-    QString secondaryBtnStyle = 
-        "QPushButton { "
-        "   background-color: #6C757D; "
-        "   border: none; "
-        "   border-radius: 4px; "
-        "   padding: 6px 12px; "
-        "   color: white; "
-        "   font-weight: 500; "
-        "   font-size: 10px; "
-        "   min-width: 60px; "
-        "}"
-        "QPushButton:hover { background-color: #5A6268; }"
-        "QPushButton:pressed { background-color: #545B62; }";
-    
     // Sort assets: put active ones first
     QVector<Asset> sortedAssets = assets;
-    
+    QVector<bool> active;
+
     if (m_isBackgroundList && !m_activeAssets.isEmpty()) {
         // For backgrounds, move active background to top
         QString activeId = m_activeAssets.first();
@@ -108,11 +68,15 @@ void AssetList::setAssets(const QVector<Asset> &assets)
                 break;
             }
         }
+        active.fill(false, sortedAssets.size());
+        if (!sortedAssets.isEmpty() && sortedAssets.first().id == activeId) {
+            active[0] = true;
+        }
     } else if (!m_isBackgroundList && !m_activeAssets.isEmpty()) {
         // For characters, move all active characters to top (in order)
         QVector<Asset> activeChars;
         QVector<Asset> inactiveChars;
-        
+
         for (const Asset &asset : sortedAssets) {
             if (m_activeAssets.contains(asset.name)) {
                 activeChars.append(asset);
@@ -120,285 +84,73 @@ void AssetList::setAssets(const QVector<Asset> &assets)
                 inactiveChars.append(asset);
             }
         }
-        
+
         // Combine: active first, then inactive
         sortedAssets = activeChars + inactiveChars;
-    }
-    
-    for (const Asset &asset : sortedAssets) {
-        auto *item = new QListWidgetItem(m_listWidget);
-        // Use a QWidget as the item widget to allow layout and buttons.
-        QWidget *row = new QWidget(m_listWidget);
-        
-        // Check if this asset is active
-        bool isActiveBackground = m_isBackgroundList && !m_activeAssets.isEmpty() && m_activeAssets.first() == asset.id;
-        bool isActiveCharacter = !m_isBackgroundList && m_activeAssets.contains(asset.name);
-        bool isActive = isActiveBackground || isActiveCharacter;
-        
-        // Different styling for active assets
-        if (isActive) {
-            row->setStyleSheet(
-                "QWidget { "
-                "   background-color: #1A3A1A; "  // Dark green background for active
-                "   border: 2px solid #28A745; "  // Green border for active
-                "   border-radius: 8px; "
-                "   padding: 8px; "
-                "}"
-                "QWidget:hover { "
-                "   background-color: #1F4A1F; "
-                "   border-color: #34D058; "
-                "}"
-            );
-        } else {
-            row->setStyleSheet(
-                "QWidget { "
-                "   background-color: #252526; "
-                "   border: 1px solid #3F3F46; "
-                "   border-radius: 8px; "
-                "   padding: 8px; "
-                "}"
-                "QWidget:hover { "
-                "   background-color: #2D2D30; "
-                "   border-color: #007ACC; "
-                "}"
-            );
+        active.fill(false, sortedAssets.size());
+        for (int i = 0; i < activeChars.size(); i++) {
+            active[i] = true;
         }
-        
-        auto *hl = new QHBoxLayout(row);
-        hl->setContentsMargins(8, 6, 8, 6);
-        hl->setSpacing(12);
-        
-        // Thumbnail preview (80x80 pixels - larger for better visibility)
-        QLabel *thumbnailLabel = new QLabel(row);
-        thumbnailLabel->setFixedSize(80, 80);
-        thumbnailLabel->setScaledContents(false);
-        thumbnailLabel->setAlignment(Qt::AlignCenter);
-        thumbnailLabel->setStyleSheet(
-            "QLabel { "
-            "   background-color: #1E1E1E; "
-            "   border: 2px solid #3F3F46; "
-            "   border-radius: 8px; "
-            "}"
-        );
-        
-        // Try to load thumbnail
-        QPixmap thumbnail(asset.file);
-        if (!thumbnail.isNull()) {
-            thumbnailLabel->setPixmap(thumbnail.scaled(76, 76, Qt::KeepAspectRatio, Qt::SmoothTransformation));
-        } else {
-            thumbnailLabel->setText("📷");
-            thumbnailLabel->setStyleSheet(thumbnailLabel->styleSheet() + "font-size: 32px;");
-        }
-        hl->addWidget(thumbnailLabel);
-        
-        // Info container (name + tags)
-        auto *infoLayout = new QVBoxLayout();
-        infoLayout->setSpacing(2);
-        
-        // Asset name with better styling
-        QLabel *nameLabel = new QLabel(asset.name, row);
-        nameLabel->setStyleSheet(
-            "color: #FFFFFF; "
-            "font-weight: 600; "
-            "font-size: 13px;"
-        );
-        infoLayout->addWidget(nameLabel);
-        
-        // Theme with badge-like appearance (for backgrounds)
-        if (m_isBackgroundList && !asset.theme.isEmpty()) {
-            QLabel *themeLabel = new QLabel("🌍 " + asset.theme, row);
-            themeLabel->setStyleSheet(
-                "color: #60A5FA; "
-                "font-size: 10px; "
-                "font-weight: 600;"
-            );
-            infoLayout->addWidget(themeLabel);
-        }
-        
-        // Tags with modern badge-like appearance
-        if (!asset.tags.isEmpty()) {
-            QLabel *tagsLabel = new QLabel("🏷 " + asset.tags.join(", "), row);
-            tagsLabel->setStyleSheet(
-                "color: #9CA3AF; "
-                "font-size: 10px; "
-                "font-style: italic;"
-            );
-            infoLayout->addWidget(tagsLabel);
-        }
-        
-        hl->addLayout(infoLayout, 1);
-        hl->addStretch(1);
-        
-        if (m_isBackgroundList) {
-            // Backgrounds: set, edit, and delete buttons
-            QString setBtnText = isActiveBackground ? "✓ Active" : "Set";
-            QPushButton *setBtn = new QPushButton(setBtnText, row);
-            
-            // Active background gets blue/green style, inactive gets primary style
-            if (isActiveBackground) {
-                setBtn->setStyleSheet(
-                    "QPushButton { "
-                    "   background-color: #28A745; "  // Green for active
-                    "   border: none; "
-                    "   border-radius: 4px; "
-                    "   padding: 6px 12px; "
-                    "   color: white; "
-                    "   font-weight: 600; "
-                    "   font-size: 10px; "
-                    "   min-width: 60px; "
-                    "}"
-                    "QPushButton:hover { background-color: #218838; }"
-                    "QPushButton:pressed { background-color: #1E7E34; }"
-                );
-            } else {
-                setBtn->setStyleSheet(primaryBtnStyle);
+    } else {
+        active.fill(false, sortedAssets.size());
+    }
+
+    m_delegate->setHoveredButton(-1, -1);
+    m_model->setAssets(sortedAssets, active);
+    // The view lays out the new rows lazily; look at what is visible
+    // once it has done so
+    QTimer::singleShot(0, this, &AssetList::updateVisibleRows);
+}
+
+void AssetList::updateVisibleRows()
+{
+    const QRect viewport = m_listView->viewport()->rect();
+    QModelIndex first = m_listView->indexAt(QPoint(viewport.center().x(), viewport.top()));
+    if (!first.isValid())
+        return;
+    QModelIndex last = m_listView->indexAt(QPoint(viewport.center().x(), viewport.bottom()));
+    int lastRow = last.isValid() ? last.row() : m_model->rowCount() - 1;
+    m_model->setVisibleRows(first.row(), lastRow);
+}
+
+void AssetList::onButtonClicked(const QModelIndex &index, const QString &action)
+{
+    if (!index.isValid())
+        return;
+    // Handlers typically rebuild the list, so hand the asset over once
+    // the view has finished processing the mouse event.
+    Asset asset = m_model->assetAt(index.row());
+    QMetaObject::invokeMethod(this, [this, asset, action]() {
+        emit assetActionTriggered(asset, action);
+    }, Qt::QueuedConnection);
+}
+
+bool AssetList::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == m_listView->viewport()) {
+        if (event->type() == QEvent::MouseMove) {
+            // Track the button under the cursor for hover colours and
+            // the pointing-hand cursor the old QPushButtons had
+            auto *mouseEvent = static_cast<QMouseEvent *>(event);
+            QPoint pos = mouseEvent->position().toPoint();
+            QModelIndex index = m_listView->indexAt(pos);
+            int button = -1;
+            if (index.isValid()) {
+                QStyleOptionViewItem option;
+                option.initFrom(m_listView);
+                option.rect = m_listView->visualRect(index);
+                button = m_delegate->buttonAt(option, index, pos);
             }
-            
-            setBtn->setCursor(Qt::PointingHandCursor);
-            connect(setBtn, &QPushButton::clicked, this, [this, asset]() {
-                emit assetActionTriggered(asset, QStringLiteral("set"));
-            });
-            hl->addWidget(setBtn);
-            
-            // Edit button for backgrounds
-            QPushButton *editBtn = new QPushButton("✏", row);
-            editBtn->setToolTip("Edit asset details");
-            editBtn->setStyleSheet(
-                "QPushButton { "
-                "   background-color: #007ACC; "
-                "   border: none; "
-                "   border-radius: 4px; "
-                "   padding: 6px 10px; "
-                "   color: white; "
-                "   font-weight: 500; "
-                "   font-size: 10px; "
-                "   min-width: 32px; "
-                "}"
-                "QPushButton:hover { background-color: #005FA3; }"
-                "QPushButton:pressed { background-color: #004578; }"
-            );
-            editBtn->setCursor(Qt::PointingHandCursor);
-            connect(editBtn, &QPushButton::clicked, this, [this, asset]() {
-                emit assetActionTriggered(asset, QStringLiteral("edit"));
-            });
-            hl->addWidget(editBtn);
-            
-            // Delete button for backgrounds
-            QPushButton *delBtn = new QPushButton("🗑", row);
-            delBtn->setToolTip("Delete from library");
-            delBtn->setStyleSheet(
-                "QPushButton { "
-                "   background-color: #DC3545; "
-                "   border: none; "
-                "   border-radius: 4px; "
-                "   padding: 6px 10px; "
-                "   color: white; "
-                "   font-weight: 500; "
-                "   font-size: 10px; "
-                "   min-width: 32px; "
-                "}"
-                "QPushButton:hover { background-color: #C82333; }"
-                "QPushButton:pressed { background-color: #BD2130; }"
-            );
-            delBtn->setCursor(Qt::PointingHandCursor);
-            connect(delBtn, &QPushButton::clicked, this, [this, asset]() {
-                emit assetActionTriggered(asset, QStringLiteral("delete"));
-            });
-            hl->addWidget(delBtn);
-        } else {
-            // Characters: toggle and bring to front buttons
-            // Use orange color if character is active
-            QString toggleBtnText = isActiveCharacter ? "👁 " + QString(obs_module_text("Hide")) : "👤 " + QString(obs_module_text("Show"));
-            QPushButton *toggleBtn = new QPushButton(toggleBtnText, row);
-            toggleBtn->setStyleSheet(isActiveCharacter ? activeBtnStyle : primaryBtnStyle);
-            toggleBtn->setCursor(Qt::PointingHandCursor);
-            connect(toggleBtn, &QPushButton::clicked, this, [this, asset]() {
-                emit assetActionTriggered(asset, QStringLiteral("toggle"));
-            });
-            hl->addWidget(toggleBtn);
-            
-            // Edit button for characters
-            QPushButton *editBtn = new QPushButton("✏", row);
-            editBtn->setToolTip("Edit asset details");
-            editBtn->setStyleSheet(
-                "QPushButton { "
-                "   background-color: #007ACC; "
-                "   border: none; "
-                "   border-radius: 4px; "
-                "   padding: 6px 10px; "
-                "   color: white; "
-                "   font-weight: 500; "
-                "   font-size: 10px; "
-                "   min-width: 32px; "
-                "}"
-                "QPushButton:hover { background-color: #005FA3; }"
-                "QPushButton:pressed { background-color: #004578; }"
-            );
-            editBtn->setCursor(Qt::PointingHandCursor);
-            connect(editBtn, &QPushButton::clicked, this, [this, asset]() {
-                emit assetActionTriggered(asset, QStringLiteral("edit"));
-            });
-            hl->addWidget(editBtn);
-            
-            // Only show "Bring to Front" and "Remove from Scene" buttons if character is active
-            if (isActiveCharacter) {
-                QPushButton *frontBtn = new QPushButton("⬆ " + QString(obs_module_text("Front")), row);
-                frontBtn->setStyleSheet(secondaryBtnStyle);
-                frontBtn->setCursor(Qt::PointingHandCursor);
-                connect(frontBtn, &QPushButton::clicked, this, [this, asset]() {
-                    emit assetActionTriggered(asset, QStringLiteral("front"));
-                });
-                hl->addWidget(frontBtn);
-                
-                // Remove from Scene button
-                QPushButton *removeBtn = new QPushButton("❌", row);
-                removeBtn->setToolTip("Remove from scene");
-                removeBtn->setStyleSheet(
-                    "QPushButton { "
-                    "   background-color: #FFC107; "
-                    "   border: none; "
-                    "   border-radius: 4px; "
-                    "   padding: 6px 10px; "
-                    "   color: white; "
-                    "   font-weight: 500; "
-                    "   font-size: 10px; "
-                    "   min-width: 32px; "
-                    "}"
-                    "QPushButton:hover { background-color: #E0A800; }"
-                    "QPushButton:pressed { background-color: #D39E00; }"
-                );
-                removeBtn->setCursor(Qt::PointingHandCursor);
-                connect(removeBtn, &QPushButton::clicked, this, [this, asset]() {
-                    emit assetActionTriggered(asset, QStringLiteral("remove"));
-                });
-                hl->addWidget(removeBtn);
+            if (m_delegate->setHoveredButton(index.isValid() ? index.row() : -1, button)) {
+                m_listView->viewport()->setCursor(button >= 0 ? Qt::PointingHandCursor : Qt::ArrowCursor);
+                m_listView->viewport()->update();
+            }
+        } else if (event->type() == QEvent::Leave) {
+            if (m_delegate->setHoveredButton(-1, -1)) {
+                m_listView->viewport()->unsetCursor();
+                m_listView->viewport()->update();
             }
-            
-            // Delete button for characters
-            QPushButton *delBtn = new QPushButton("🗑", row);
-            delBtn->setToolTip("Delete from library");
-            delBtn->setStyleSheet(
-                "QPushButton { "
-                "   background-color: #DC3545; "
-                "   border: none; "
-                "   border-radius: 4px; "
-                "   padding: 6px 10px; "
-                "   color: white; "
-                "   font-weight: 500; "
-                "   font-size: 10px; "
-                "   min-width: 32px; "
-                "}"
-                "QPushButton:hover { background-color: #C82333; }"
-                "QPushButton:pressed { background-color: #BD2130; }"
-            );
-            delBtn->setCursor(Qt::PointingHandCursor);
-            connect(delBtn, &QPushButton::clicked, this, [this, asset]() {
-                emit assetActionTriggered(asset, QStringLiteral("delete"));
-            });
-            hl->addWidget(delBtn);
         }
-        
-        item->setSizeHint(row->sizeHint());
-        m_listWidget->setItemWidget(item, row);
     }
-}
\ No newline at end of file
+    return QWidget::eventFilter(watched, event);
+}
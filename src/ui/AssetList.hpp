@@ -14,10 +14,18 @@
  * button the assetActionTriggered signal is emitted with an action
  * string: "set" for backgrounds or "toggle" / "front" for
  * characters.
+ *
+ * Rows live in an AssetListModel and are painted by an
+ * AssetItemDelegate, so no widgets are created per asset and only the
+ * rows scrolled into view are drawn.  Thumbnails are decoded in the
+ * background; decodes for rows scrolled away before they started are
+ * cancelled.
  */
 
-class QListWidget;
-class QListWidgetItem;
+class QListView;
+class QModelIndex;
+class AssetListModel;
+class AssetItemDelegate;
 
 class AssetList : public QWidget
 {
@@ -27,7 +35,7 @@ public:
 
     /** Replace the contents of the list with the provided assets. */
     void setAssets(const QVector<Asset> &assets);
-    
+
     /** Set which assets are currently active (visible in scene) */
     void setActiveAssets(const QStringList &activeNames);
 
@@ -41,8 +49,16 @@ signals:
      */
     void assetActionTriggered(const Asset &asset, const QString &action);
 
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
 private:
+    void onButtonClicked(const QModelIndex &index, const QString &action);
+    void updateVisibleRows();
+
     bool m_isBackgroundList;
-    QListWidget *m_listWidget;
+    QListView *m_listView;
+    AssetListModel *m_model;
+    AssetItemDelegate *m_delegate;
     QStringList m_activeAssets;
 };
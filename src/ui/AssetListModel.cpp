@@ -0,0 +1,180 @@
+#include "AssetListModel.hpp"
+#include "ThumbnailLoader.hpp"
+#include "ThumbnailCache.hpp"
+
+namespace {
+
+const QSize kThumbnailSize(76, 76);
+
+} // namespace
+
+AssetListModel::AssetListModel(QObject *parent)
+    : QAbstractListModel(parent), m_loader(new ThumbnailLoader(this))
+{
+    connect(m_loader, &ThumbnailLoader::thumbnailReady, this, &AssetListModel::onThumbnailReady);
+}
+
+int AssetListModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return m_assets.size();
+}
+
+QVariant AssetListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_assets.size())
+        return QVariant();
+    const Asset &asset = m_assets.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+        return asset.name;
+    case ActiveRole:
+        return m_active.at(index.row());
+    case ThemeRole:
+        return asset.theme;
+    case TagsRole:
+        return asset.tags;
+    case FileRole:
+        return asset.file;
+    case ThumbnailRole:
+        return thumbnailFor(asset.file);
+    default:
+        return QVariant();
+    }
+}
+
+void AssetListModel::setAssets(const QVector<Asset> &assets, const QVector<bool> &active)
+{
+    QVector<bool> newActive = active;
+    newActive.resize(assets.size());
+
+    // The diff identifies rows by asset id.  Libraries with duplicate
+    // ids cannot be diffed reliably, so they fall back to a full reset.
+    QSet<QString> newIds;
+    newIds.reserve(assets.size());
+    for (const Asset &asset : assets)
+        newIds.insert(asset.id);
+    QSet<QString> oldIds;
+    oldIds.reserve(m_assets.size());
+    for (const Asset &asset : m_assets)
+        oldIds.insert(asset.id);
+    if (newIds.size() != assets.size() || oldIds.size() != m_assets.size()) {
+        beginResetModel();
+        m_assets = assets;
+        m_active = newActive;
+        endResetModel();
+        rebuildFileRows();
+        return;
+    }
+
+    // Removals first, back to front so earlier row numbers stay valid.
+    // Contiguous runs go out in one batch.
+    for (int last = m_assets.size() - 1; last >= 0; --last) {
+        if (newIds.contains(m_assets[last].id))
+            continue;
+        int first = last;
+        while (first > 0 && !newIds.contains(m_assets[first - 1].id))
+            --first;
+        beginRemoveRows(QModelIndex(), first, last);
+        for (int row = first; row <= last; ++row)
+            oldIds.remove(m_assets[row].id);
+        m_assets.remove(first, last - first + 1);
+        m_active.remove(first, last - first + 1);
+        endRemoveRows();
+        last = first;
+    }
+
+    // Then walk the new order.  Row i is either already correct, moved
+    // up from further down, or the start of a run of new assets.
+    for (int i = 0; i < assets.size(); ++i) {
+        const Asset &wanted = assets[i];
+        if (i < m_assets.size() && m_assets[i].id == wanted.id) {
+            updateRow(i, wanted, newActive[i]);
+            continue;
+        }
+        if (oldIds.contains(wanted.id)) {
+            int from = i + 1;
+            while (m_assets[from].id != wanted.id)
+                ++from;
+            if (beginMoveRows(QModelIndex(), from, from, QModelIndex(), i)) {
+                m_assets.move(from, i);
+                m_active.move(from, i);
+                endMoveRows();
+            }
+            updateRow(i, wanted, newActive[i]);
+            continue;
+        }
+        int end = i + 1;
+        while (end < assets.size() && !oldIds.contains(assets[end].id))
+            ++end;
+        beginInsertRows(QModelIndex(), i, end - 1);
+        for (int k = i; k < end; ++k) {
+            m_assets.insert(k, assets[k]);
+            m_active.insert(k, newActive[k]);
+        }
+        endInsertRows();
+        i = end - 1;
+    }
+    rebuildFileRows();
+}
+
+void AssetListModel::updateRow(int row, const Asset &asset, bool active)
+{
+    Asset &current = m_assets[row];
+    const bool changed = m_active[row] != active
+            || current.name != asset.name
+            || current.theme != asset.theme
+            || current.tags != asset.tags
+            || current.file != asset.file;
+    // Always take the new value so derived fields stay current
+    current = asset;
+    m_active[row] = active;
+    if (changed) {
+        QModelIndex idx = index(row);
+        emit dataChanged(idx, idx);
+    }
+}
+
+void AssetListModel::rebuildFileRows()
+{
+    m_rowsByFile.clear();
+    for (int row = 0; row < m_assets.size(); ++row)
+        m_rowsByFile[m_assets[row].file].push_back(row);
+}
+
+void AssetListModel::setVisibleRows(int firstRow, int lastRow)
+{
+    QSet<QString> visible;
+    for (int row = qMax(0, firstRow); row <= lastRow && row < m_assets.size(); ++row)
+        visible.insert(m_assets[row].file);
+    m_loader->cancelAllExcept(visible);
+}
+
+QPixmap AssetListModel::thumbnailFor(const QString &file) const
+{
+    const int scale = ThumbnailCache::preferredScale();
+    QPixmap thumbnail;
+    if (ThumbnailCache::instance().find(ThumbnailCache::keyFor(file, scale), &thumbnail))
+        return thumbnail;
+    // Only rows that are actually painted get here.  The decode happens
+    // off the GUI thread and the row repaints once it is done.
+    m_loader->request(file, kThumbnailSize, scale);
+    return QPixmap();
+}
+
+void AssetListModel::onThumbnailReady(const QString &file, const QImage &image)
+{
+    // Unreadable files are remembered so they are not retried until
+    // they change
+    const QString key = ThumbnailCache::keyFor(file, ThumbnailCache::preferredScale());
+    if (image.isNull())
+        ThumbnailCache::instance().insertFailure(key, file);
+    else
+        ThumbnailCache::instance().insert(key, QPixmap::fromImage(image));
+    const QVector<int> rows = m_rowsByFile.value(file);
+    for (int row : rows) {
+        QModelIndex idx = index(row);
+        emit dataChanged(idx, idx, {ThumbnailRole});
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QPixmap>
+#include <QSet>
+#include <QVector>
+#include "asset_library.hpp"
+
+/*
+ * AssetListModel
+ *
+ * List model behind AssetList.  Each row is one asset together with a
+ * flag saying whether it is currently active (the scene's background or
+ * a visible character).  Rows are painted by AssetItemDelegate, so only
+ * the rows scrolled into view cost anything.  Thumbnails come from the
+ * shared ThumbnailCache; on a miss they are requested from a
+ * ThumbnailLoader and the row is painted with a placeholder until the
+ * decoded image arrives.
+ */
+
+class ThumbnailLoader;
+
+class AssetListModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    enum Roles {
+        ActiveRole = Qt::UserRole + 1,
+        ThemeRole,
+        TagsRole,
+        FileRole,
+        ThumbnailRole
+    };
+
+    explicit AssetListModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    /**
+     * Replace all rows.  active must have the same size as assets.  The
+     * change is applied as a diff against the current rows (removals,
+     * moves, insertions and per-row data changes) so views keep their
+     * scroll position and only touch rows that actually changed.
+     */
+    void setAssets(const QVector<Asset> &assets, const QVector<bool> &active);
+
+    const Asset &assetAt(int row) const { return m_assets.at(row); }
+    bool isActive(int row) const { return m_active.at(row); }
+
+    /** Cancel pending thumbnail decodes for every row outside
+     * [firstRow, lastRow]. */
+    void setVisibleRows(int firstRow, int lastRow);
+
+private:
+    QPixmap thumbnailFor(const QString &file) const;
+    void onThumbnailReady(const QString &file, const QImage &image);
+    void updateRow(int row, const Asset &asset, bool active);
+    void rebuildFileRows();
+
+    QVector<Asset> m_assets;
+    QVector<bool> m_active;
+    QHash<QString, QVector<int>> m_rowsByFile;
+    ThumbnailLoader *m_loader;
+};
@@ -124,6 +124,24 @@ HeaderBar::HeaderBar(QWidget *parent)
     gridSettingsBtn->setVisible(false);  // HIDDEN
     connect(gridSettingsBtn, &QPushButton::clicked, this, &HeaderBar::gridSettingsRequested);
     
+    // Snap every character in the scene to the grid at once
+    QPushButton *snapAllBtn = new QPushButton("📐 Snap All", this);
+    snapAllBtn->setToolTip("Snap all characters in the scene to the grid (pinned sources stay put)");
+    snapAllBtn->setStyleSheet(
+        "QPushButton { "
+        "   background-color: #2D2D30; "
+        "   border: 1px solid #3F3F46; "
+        "   border-radius: 4px; "
+        "   padding: 8px 16px; "
+        "   color: #E0E0E0; "
+        "   font-weight: 500; "
+        "   font-size: 11px; "
+        "}"
+        "QPushButton:hover { border: 1px solid #007ACC; }"
+        "QPushButton:pressed { background-color: #3F3F46; }"
+    );
+    connect(snapAllBtn, &QPushButton::clicked, this, &HeaderBar::snapAllRequested);
+    
     // Settings button for pinned sources - IMPROVED ICON
     QPushButton *settingsBtn = new QPushButton("📍 Pinned Sources", this);
     settingsBtn->setToolTip("Configure sources that always stay on top (Camera, Player, etc.)");
@@ -157,6 +175,7 @@ HeaderBar::HeaderBar(QWidget *parent)
     // layout->addWidget(m_gridCheckbox);
     // layout->addWidget(gridSettingsBtn);
     layout->addWidget(m_autoButton);
+    layout->addWidget(snapAllBtn);
     layout->addWidget(settingsBtn);
 }
 
@@ -41,6 +41,7 @@ signals:
     void pinnedSourcesSettingsRequested();
     void gridToggled(bool enabled);
     void gridSettingsRequested();
+    void snapAllRequested();
 
 private slots:
     void onSceneActivated(int index);
@@ -0,0 +1,144 @@
+#include "ThumbnailCache.hpp"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QGuiApplication>
+
+namespace {
+
+// Bookkeeping cost charged for entries without pixel data
+const qint64 kMinimumCost = 64;
+
+// How often an unreadable file is looked at again.  find() runs on
+// every paint of its row, and each check is a stat on the GUI thread.
+const qint64 kFailureRecheckMs = 5000;
+
+qint64 monotonicMs()
+{
+    static QElapsedTimer clock;
+    if (!clock.isValid())
+        clock.start();
+    return clock.elapsed();
+}
+
+} // namespace
+
+ThumbnailCache &ThumbnailCache::instance()
+{
+    static ThumbnailCache cache;
+    return cache;
+}
+
+QString ThumbnailCache::keyFor(const QString &file, int scale)
+{
+    return file + QLatin1Char('@') + QString::number(scale);
+}
+
+int ThumbnailCache::preferredScale()
+{
+    // HiDPI screens get a 2x thumbnail so it stays sharp
+    return qApp->devicePixelRatio() > 1.0 ? 2 : 1;
+}
+
+bool ThumbnailCache::find(const QString &key, QPixmap *pixmap)
+{
+    auto it = m_nodes.find(key);
+    if (it == m_nodes.end()) {
+        ++m_misses;
+        return false;
+    }
+    Node &node = *it.value();
+    if (!node.failedFile.isEmpty() && monotonicMs() - node.failedCheckedAt >= kFailureRecheckMs) {
+        node.failedCheckedAt = monotonicMs();
+        if (stampOf(node.failedFile) != node.failedStamp) {
+            // The unreadable file was replaced; try it again
+            m_bytes -= node.cost;
+            m_lru.erase(it.value());
+            m_nodes.erase(it);
+            ++m_misses;
+            return false;
+        }
+    }
+    ++m_hits;
+    m_lru.splice(m_lru.begin(), m_lru, it.value());
+    *pixmap = it.value()->pixmap;
+    return true;
+}
+
+void ThumbnailCache::insert(const QString &key, const QPixmap &pixmap)
+{
+    auto it = m_nodes.find(key);
+    if (it != m_nodes.end()) {
+        m_bytes -= it.value()->cost;
+        m_lru.erase(it.value());
+        m_nodes.erase(it);
+    }
+    const qint64 cost = costOf(pixmap);
+    m_lru.push_front(Node{key, pixmap, cost});
+    m_nodes.insert(key, m_lru.begin());
+    m_bytes += cost;
+    trim();
+}
+
+void ThumbnailCache::insertFailure(const QString &key, const QString &file)
+{
+    insert(key, QPixmap());
+    // insert() always leaves the new entry in front
+    m_lru.front().failedFile = file;
+    m_lru.front().failedStamp = stampOf(file);
+    m_lru.front().failedCheckedAt = monotonicMs();
+}
+
+void ThumbnailCache::setBudget(qint64 bytes)
+{
+    m_budget = qMax<qint64>(0, bytes);
+    trim();
+}
+
+ThumbnailCache::Stats ThumbnailCache::stats() const
+{
+    Stats s;
+    s.hits = m_hits;
+    s.misses = m_misses;
+    s.evictions = m_evictions;
+    s.bytes = m_bytes;
+    s.entries = m_nodes.size();
+    return s;
+}
+
+void ThumbnailCache::clear()
+{
+    m_lru.clear();
+    m_nodes.clear();
+    m_bytes = 0;
+}
+
+qint64 ThumbnailCache::costOf(const QPixmap &pixmap)
+{
+    if (pixmap.isNull())
+        return kMinimumCost;
+    return qMax(kMinimumCost, qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8);
+}
+
+QString ThumbnailCache::stampOf(const QString &file)
+{
+    const QFileInfo info(file);
+    if (!info.exists())
+        return QString();
+    return QString::number(info.lastModified().toMSecsSinceEpoch()) + QLatin1Char('|')
+           + QString::number(info.size());
+}
+
+void ThumbnailCache::trim()
+{
+    // Always keep the most recent entry, even if it alone exceeds the
+    // budget, so that the row that asked for it can still be painted
+    while (m_bytes > m_budget && m_lru.size() > 1) {
+        const Node &last = m_lru.back();
+        m_bytes -= last.cost;
+        m_nodes.remove(last.key);
+        m_lru.pop_back();
+        ++m_evictions;
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <QHash>
+#include <QPixmap>
+#include <QString>
+#include <list>
+
+/*
+ * ThumbnailCache
+ *
+ * Process‑wide, in‑memory LRU cache of decoded thumbnails shared by
+ * both asset lists and the setup dialog, so toggling a character or
+ * refreshing a list never decodes a thumbnail that is still in memory.
+ * The cache is bounded by a byte budget (approximate pixel memory) and
+ * evicts least recently used entries once over it.  Hit, miss and
+ * eviction counters are kept for sizing the budget.
+ *
+ * Like QPixmap itself, the cache must only be used from the GUI thread,
+ * and it must be cleared before the application object goes away (the
+ * dock does so when it is destroyed).
+ */
+
+class ThumbnailCache
+{
+public:
+    struct Stats {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 evictions = 0;
+        qint64 bytes = 0;
+        int entries = 0;
+    };
+
+    static ThumbnailCache &instance();
+
+    /** Cache key for a file at a device pixel ratio. */
+    static QString keyFor(const QString &file, int scale);
+
+    /** Device pixel ratio thumbnails should be rendered at, 1 or 2. */
+    static int preferredScale();
+
+    /** Look up a thumbnail and mark it most recently used.  A null
+     * pixmap records a file that could not be read; it is dropped, and
+     * the lookup misses, once the file has changed on disk.  That is
+     * checked at most every few seconds per file, not on every paint. */
+    bool find(const QString &key, QPixmap *pixmap);
+
+    /** Insert or replace a thumbnail, evicting as needed. */
+    void insert(const QString &key, const QPixmap &pixmap);
+
+    /** Record that file could not be read, so it is not retried until
+     * it changes. */
+    void insertFailure(const QString &key, const QString &file);
+
+    /** Set the byte budget; shrinks the cache immediately if needed. */
+    void setBudget(qint64 bytes);
+    qint64 budget() const { return m_budget; }
+
+    Stats stats() const;
+    void clear();
+
+private:
+    ThumbnailCache() = default;
+
+    struct Node {
+        QString key;
+        QPixmap pixmap;
+        qint64 cost;
+        QString failedFile;   // Set for failures only
+        QString failedStamp;  // The file's mtime and size when it failed
+        qint64 failedCheckedAt = 0;  // When failedStamp was last compared, monotonic ms
+    };
+
+    static qint64 costOf(const QPixmap &pixmap);
+    static QString stampOf(const QString &file);
+    void trim();
+
+    std::list<Node> m_lru;  // Most recently used first
+    QHash<QString, std::list<Node>::iterator> m_nodes;
+    qint64 m_budget = 64ll * 1024 * 1024;
+    qint64 m_bytes = 0;
+    quint64 m_hits = 0;
+    quint64 m_misses = 0;
+    quint64 m_evictions = 0;
+};
@@ -0,0 +1,115 @@
+#include "ThumbnailLoader.hpp"
+#include "thumbnail_store.hpp"
+
+#include <QImageReader>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+
+class ThumbnailJob : public QRunnable
+{
+public:
+    ThumbnailJob(ThumbnailLoader *loader, const QString &file, const QSize &size, int scale)
+        : m_loader(loader), m_file(file), m_size(size), m_scale(scale)
+    {
+        setAutoDelete(true);
+    }
+
+    void run() override
+    {
+        QImage image = ThumbnailLoader::decode(m_file, m_size, m_scale);
+        m_loader->jobFinished(this, m_file, image);
+    }
+
+private:
+    ThumbnailLoader *m_loader;
+    QString m_file;
+    QSize m_size;
+    int m_scale;
+};
+
+ThumbnailLoader::ThumbnailLoader(QObject *parent)
+    : QObject(parent)
+{
+    // Leave at least one core to OBS's own render and encode threads
+    m_pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount() / 2, 4));
+}
+
+ThumbnailLoader::~ThumbnailLoader()
+{
+    // Drop queued jobs and wait for the running ones, which still
+    // report back through this object.
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+void ThumbnailLoader::request(const QString &file, const QSize &size, int scale)
+{
+    QMutexLocker locker(&m_mutex);
+    if (m_pending.contains(file))
+        return;
+    auto *job = new ThumbnailJob(this, file, size, scale);
+    m_pending.insert(file, job);
+    m_pool.start(job);
+}
+
+bool ThumbnailLoader::isPending(const QString &file) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_pending.contains(file);
+}
+
+void ThumbnailLoader::cancelAllExcept(const QSet<QString> &keep)
+{
+    // Jobs remove themselves from m_pending under the mutex before they
+    // are deleted, so every pointer seen here is still alive.
+    QMutexLocker locker(&m_mutex);
+    for (auto it = m_pending.begin(); it != m_pending.end();) {
+        if (!keep.contains(it.key()) && m_pool.tryTake(it.value())) {
+            // tryTake hands ownership of a job that never started back
+            // to us, regardless of autoDelete
+            delete it.value();
+            it = m_pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+QImage ThumbnailLoader::decode(const QString &file, const QSize &size, int scale)
+{
+    QImage image;
+    if (ThumbnailStore::instance().load(file, scale, &image))
+        return image;
+
+    const QSize target = size * scale;
+    QImageReader reader(file);
+    QSize original = reader.size();
+    if (original.isValid()) {
+        // Ask the decoder for the reduced size up front; JPEG in
+        // particular can then skip most of the work.
+        reader.setScaledSize(original.scaled(target, Qt::KeepAspectRatio));
+    }
+    image = reader.read();
+    if (image.isNull())
+        return image;
+    // Some formats ignore the scaled size hint
+    if (image.width() > target.width() || image.height() > target.height())
+        image = image.scaled(target, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    image.setDevicePixelRatio(scale);
+    ThumbnailStore::instance().store(file, scale, image);
+    return image;
+}
+
+void ThumbnailLoader::jobFinished(ThumbnailJob *job, const QString &file, const QImage &image)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_pending.find(file);
+        if (it != m_pending.end() && it.value() == job)
+            m_pending.erase(it);
+    }
+    QMetaObject::invokeMethod(this, [this, file, image]() {
+        emit thumbnailReady(file, image);
+    }, Qt::QueuedConnection);
+}
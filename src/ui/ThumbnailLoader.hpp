@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QSize>
+#include <QThreadPool>
+
+/*
+ * ThumbnailLoader
+ *
+ * Decodes thumbnails on a small pool of worker threads so that the GUI
+ * thread never has to decode a full‑resolution image.  Images are read
+ * with QImageReader::setScaledSize, which lets formats such as JPEG
+ * decode directly at reduced size, and are kept in the on‑disk
+ * ThumbnailStore so that later sessions skip the source image entirely.
+ * Finished images are delivered on the loader's thread through
+ * thumbnailReady.
+ *
+ * Requests that have not started decoding yet can be withdrawn with
+ * cancelAllExcept(), which AssetList uses to drop rows that scrolled
+ * out of view.
+ */
+
+class ThumbnailJob;
+
+class ThumbnailLoader : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ThumbnailLoader(QObject *parent = nullptr);
+    ~ThumbnailLoader();
+
+    /** Queue a decode of file scaled to fit size (in device‑independent
+     * pixels) at the given device pixel ratio, 1 or 2.  Does nothing if
+     * a request for the same file is already pending. */
+    void request(const QString &file, const QSize &size, int scale = 1);
+
+    /** True if a request for file is queued or decoding. */
+    bool isPending(const QString &file) const;
+
+    /** Withdraw every queued request whose file is not in keep.
+     * Requests already decoding are left to finish. */
+    void cancelAllExcept(const QSet<QString> &keep);
+
+    /** Produce the thumbnail for file, from the thumbnail store if
+     * possible and otherwise by decoding the source.  Safe to call from
+     * any thread; returns a null image if the file cannot be read. */
+    static QImage decode(const QString &file, const QSize &size, int scale);
+
+signals:
+    void thumbnailReady(const QString &file, const QImage &image);
+
+private:
+    friend class ThumbnailJob;
+    void jobFinished(ThumbnailJob *job, const QString &file, const QImage &image);
+
+    QThreadPool m_pool;
+    mutable QMutex m_mutex;
+    QHash<QString, ThumbnailJob *> m_pending;  // Guarded by m_mutex
+};
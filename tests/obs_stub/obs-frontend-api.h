@@ -0,0 +1,22 @@
+#pragma once
+
+/*
+ * obs-frontend-api.h (test stub)
+ *
+ * Frontend event callbacks as declared by the real header.  Events are
+ * raised from the tests through obs_stub::frontendEvent().
+ */
+
+enum obs_frontend_event {
+    OBS_FRONTEND_EVENT_SCENE_CHANGED,
+    OBS_FRONTEND_EVENT_SCENE_LIST_CHANGED,
+    OBS_FRONTEND_EVENT_EXIT,
+    OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGING,
+    OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGED,
+    OBS_FRONTEND_EVENT_SCENE_COLLECTION_CLEANUP,
+};
+
+typedef void (*obs_frontend_event_cb)(enum obs_frontend_event event, void *private_data);
+
+void obs_frontend_add_event_callback(obs_frontend_event_cb callback, void *private_data);
+void obs_frontend_remove_event_callback(obs_frontend_event_cb callback, void *private_data);
@@ -0,0 +1,56 @@
+#pragma once
+
+/*
+ * obs.h (test stub)
+ *
+ * The subset of the libobs API used by the code under test, declared
+ * with the same names and signatures as the real header.  The
+ * implementation in obs_stub.cpp keeps scenes, items and sources in
+ * memory and raises the same signals libobs does, synchronously on the
+ * calling thread.  obs_stub.hpp drives it from the tests.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct obs_source obs_source_t;
+typedef struct obs_weak_source obs_weak_source_t;
+typedef struct obs_scene obs_scene_t;
+typedef struct obs_scene_item obs_sceneitem_t;
+typedef struct obs_data obs_data_t;
+typedef struct calldata calldata_t;
+typedef struct signal_handler signal_handler_t;
+
+typedef void (*signal_callback_t)(void *data, calldata_t *cd);
+
+/* Sources */
+obs_source_t *obs_get_source_by_name(const char *name);
+void obs_source_release(obs_source_t *source);
+const char *obs_source_get_name(const obs_source_t *source);
+obs_data_t *obs_source_get_settings(const obs_source_t *source);
+signal_handler_t *obs_source_get_signal_handler(const obs_source_t *source);
+obs_weak_source_t *obs_source_get_weak_source(obs_source_t *source);
+obs_source_t *obs_weak_source_get_source(obs_weak_source_t *weak);
+void obs_weak_source_release(obs_weak_source_t *weak);
+
+/* Scenes */
+typedef bool (*obs_scene_enum_items_cb)(obs_scene_t *scene, obs_sceneitem_t *item, void *param);
+obs_scene_t *obs_scene_from_source(const obs_source_t *source);
+void obs_scene_enum_items(obs_scene_t *scene, obs_scene_enum_items_cb callback, void *param);
+obs_source_t *obs_sceneitem_get_source(const obs_sceneitem_t *item);
+bool obs_sceneitem_visible(const obs_sceneitem_t *item);
+int64_t obs_sceneitem_get_id(const obs_sceneitem_t *item);
+
+/* Settings */
+const char *obs_data_get_string(obs_data_t *data, const char *name);
+void obs_data_release(obs_data_t *data);
+
+/* Signals */
+signal_handler_t *obs_get_signal_handler(void);
+void signal_handler_connect(signal_handler_t *handler, const char *signal,
+                            signal_callback_t callback, void *data);
+void signal_handler_disconnect(signal_handler_t *handler, const char *signal,
+                               signal_callback_t callback, void *data);
+void *calldata_ptr(const calldata_t *data, const char *name);
+bool calldata_bool(const calldata_t *data, const char *name);
@@ -0,0 +1,381 @@
+#include "obs_stub.hpp"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+
+struct signal_handler {
+    struct Slot {
+        std::string signal;
+        signal_callback_t callback;
+        void *data;
+    };
+    std::vector<Slot> slots;
+};
+
+struct calldata {
+    std::map<std::string, void *> ptrs;
+    std::map<std::string, bool> bools;
+};
+
+struct obs_data {
+    std::map<std::string, std::string> strings;
+};
+
+struct obs_weak_source {
+    obs_source_t *source = nullptr;
+};
+
+struct obs_source {
+    std::string name;
+    obs_data settings;
+    signal_handler handler;
+    obs_weak_source weak;
+    obs_scene_t *scene = nullptr;
+    bool destroyed = false;
+};
+
+struct obs_scene_item {
+    int64_t id = 0;
+    obs_scene_t *scene = nullptr;
+    obs_source_t *source = nullptr;
+    bool visible = true;
+};
+
+struct obs_scene {
+    obs_source_t *source = nullptr;
+    std::vector<obs_sceneitem_t *> items;  // Bottom to top
+    int64_t nextId = 1;
+};
+
+namespace {
+
+struct World {
+    std::vector<std::unique_ptr<obs_source>> sources;
+    std::vector<std::unique_ptr<obs_scene>> scenes;
+    std::vector<std::unique_ptr<obs_scene_item>> items;
+    signal_handler global;
+    std::vector<std::pair<obs_frontend_event_cb, void *>> frontendCallbacks;
+    int enumerations = 0;
+    int references = 0;
+};
+
+World &world()
+{
+    static World w;
+    return w;
+}
+
+void emitSignal(signal_handler_t *handler, const char *signal, calldata_t *cd)
+{
+    // Copy first: callbacks may connect or disconnect while dispatching
+    const std::vector<signal_handler::Slot> slots = handler->slots;
+    for (const auto &slot : slots) {
+        if (slot.signal == signal)
+            slot.callback(slot.data, cd);
+    }
+}
+
+void emitItemSignal(obs_sceneitem_t *item, const char *signal)
+{
+    calldata_t cd;
+    cd.ptrs["scene"] = item->scene;
+    cd.ptrs["item"] = item;
+    emitSignal(&item->scene->source->handler, signal, &cd);
+}
+
+obs_source_t *newSource(const std::string &name)
+{
+    auto source = std::make_unique<obs_source>();
+    source->name = name;
+    source->weak.source = source.get();
+    world().sources.push_back(std::move(source));
+    return world().sources.back().get();
+}
+
+} // namespace
+
+/* libobs */
+
+obs_source_t *obs_get_source_by_name(const char *name)
+{
+    for (const auto &source : world().sources) {
+        if (!source->destroyed && source->name == name) {
+            ++world().references;
+            return source.get();
+        }
+    }
+    return nullptr;
+}
+
+void obs_source_release(obs_source_t *source)
+{
+    if (source)
+        --world().references;
+}
+
+const char *obs_source_get_name(const obs_source_t *source)
+{
+    return source ? source->name.c_str() : nullptr;
+}
+
+obs_data_t *obs_source_get_settings(const obs_source_t *source)
+{
+    if (!source)
+        return nullptr;
+    ++world().references;
+    return const_cast<obs_data_t *>(&source->settings);
+}
+
+signal_handler_t *obs_source_get_signal_handler(const obs_source_t *source)
+{
+    return source ? const_cast<signal_handler_t *>(&source->handler) : nullptr;
+}
+
+obs_weak_source_t *obs_source_get_weak_source(obs_source_t *source)
+{
+    if (!source)
+        return nullptr;
+    ++world().references;
+    return &source->weak;
+}
+
+obs_source_t *obs_weak_source_get_source(obs_weak_source_t *weak)
+{
+    if (!weak || weak->source->destroyed)
+        return nullptr;
+    ++world().references;
+    return weak->source;
+}
+
+void obs_weak_source_release(obs_weak_source_t *weak)
+{
+    if (weak)
+        --world().references;
+}
+
+obs_scene_t *obs_scene_from_source(const obs_source_t *source)
+{
+    return source ? source->scene : nullptr;
+}
+
+void obs_scene_enum_items(obs_scene_t *scene, obs_scene_enum_items_cb callback, void *param)
+{
+    if (!scene)
+        return;
+    ++world().enumerations;
+    for (obs_sceneitem_t *item : scene->items) {
+        if (!callback(scene, item, param))
+            break;
+    }
+}
+
+obs_source_t *obs_sceneitem_get_source(const obs_sceneitem_t *item)
+{
+    return item ? item->source : nullptr;
+}
+
+bool obs_sceneitem_visible(const obs_sceneitem_t *item)
+{
+    return item && item->visible;
+}
+
+int64_t obs_sceneitem_get_id(const obs_sceneitem_t *item)
+{
+    return item ? item->id : 0;
+}
+
+const char *obs_data_get_string(obs_data_t *data, const char *name)
+{
+    auto it = data->strings.find(name);
+    return it != data->strings.end() ? it->second.c_str() : "";
+}
+
+void obs_data_release(obs_data_t *data)
+{
+    if (data)
+        --world().references;
+}
+
+signal_handler_t *obs_get_signal_handler(void)
+{
+    return &world().global;
+}
+
+void signal_handler_connect(signal_handler_t *handler, const char *signal,
+                            signal_callback_t callback, void *data)
+{
+    if (handler)
+        handler->slots.push_back({signal, callback, data});
+}
+
+void signal_handler_disconnect(signal_handler_t *handler, const char *signal,
+                               signal_callback_t callback, void *data)
+{
+    if (!handler)
+        return;
+    auto &slots = handler->slots;
+    auto it = std::find_if(slots.begin(), slots.end(), [&](const signal_handler::Slot &slot) {
+        return slot.signal == signal && slot.callback == callback && slot.data == data;
+    });
+    if (it != slots.end())
+        slots.erase(it);
+}
+
+void *calldata_ptr(const calldata_t *data, const char *name)
+{
+    auto it = data->ptrs.find(name);
+    return it != data->ptrs.end() ? it->second : nullptr;
+}
+
+bool calldata_bool(const calldata_t *data, const char *name)
+{
+    auto it = data->bools.find(name);
+    return it != data->bools.end() && it->second;
+}
+
+/* obs-frontend-api */
+
+void obs_frontend_add_event_callback(obs_frontend_event_cb callback, void *private_data)
+{
+    world().frontendCallbacks.emplace_back(callback, private_data);
+}
+
+void obs_frontend_remove_event_callback(obs_frontend_event_cb callback, void *private_data)
+{
+    auto &callbacks = world().frontendCallbacks;
+    auto it = std::find(callbacks.begin(), callbacks.end(), std::make_pair(callback, private_data));
+    if (it != callbacks.end())
+        callbacks.erase(it);
+}
+
+/* Test controls */
+
+namespace obs_stub {
+
+void reset()
+{
+    World &w = world();
+    w.items.clear();
+    w.scenes.clear();
+    w.sources.clear();
+    w.global.slots.clear();
+    w.frontendCallbacks.clear();
+    w.enumerations = 0;
+    w.references = 0;
+}
+
+obs_source_t *createScene(const std::string &name)
+{
+    obs_source_t *source = newSource(name);
+    auto scene = std::make_unique<obs_scene>();
+    scene->source = source;
+    source->scene = scene.get();
+    world().scenes.push_back(std::move(scene));
+    return source;
+}
+
+obs_sceneitem_t *addImage(obs_source_t *scene, const std::string &name, const std::string &file)
+{
+    obs_source_t *source = newSource(name);
+    source->settings.strings["file"] = file;
+    auto item = std::make_unique<obs_scene_item>();
+    item->id = scene->scene->nextId++;
+    item->scene = scene->scene;
+    item->source = source;
+    world().items.push_back(std::move(item));
+
+    obs_sceneitem_t *added = world().items.back().get();
+    scene->scene->items.push_back(added);
+    emitItemSignal(added, "item_add");
+    return added;
+}
+
+void removeItem(obs_sceneitem_t *item)
+{
+    auto &items = item->scene->items;
+    items.erase(std::remove(items.begin(), items.end(), item), items.end());
+    emitItemSignal(item, "item_remove");
+}
+
+void moveToTop(obs_sceneitem_t *item)
+{
+    auto &items = item->scene->items;
+    items.erase(std::remove(items.begin(), items.end(), item), items.end());
+    items.push_back(item);
+    calldata_t cd;
+    cd.ptrs["scene"] = item->scene;
+    emitSignal(&item->scene->source->handler, "reorder", &cd);
+}
+
+void setVisible(obs_sceneitem_t *item, bool visible)
+{
+    item->visible = visible;
+    calldata_t cd;
+    cd.ptrs["scene"] = item->scene;
+    cd.ptrs["item"] = item;
+    cd.bools["visible"] = visible;
+    emitSignal(&item->scene->source->handler, "item_visible", &cd);
+}
+
+void setFile(const std::string &sourceName, const std::string &file)
+{
+    for (const auto &source : world().sources) {
+        if (source->destroyed || source->name != sourceName)
+            continue;
+        source->settings.strings["file"] = file;
+        calldata_t cd;
+        cd.ptrs["source"] = source.get();
+        emitSignal(&world().global, "source_update", &cd);
+    }
+}
+
+void rename(obs_source_t *source, const std::string &name)
+{
+    const std::string previous = source->name;
+    source->name = name;
+    calldata_t cd;
+    cd.ptrs["source"] = source;
+    cd.ptrs["new_name"] = const_cast<char *>(source->name.c_str());
+    cd.ptrs["prev_name"] = const_cast<char *>(previous.c_str());
+    emitSignal(&source->handler, "rename", &cd);
+}
+
+void removeScene(obs_source_t *scene)
+{
+    calldata_t cd;
+    cd.ptrs["source"] = scene;
+    emitSignal(&scene->handler, "remove", &cd);
+    emitSignal(&scene->handler, "destroy", &cd);
+    scene->destroyed = true;
+    scene->handler.slots.clear();
+}
+
+void frontendEvent(enum obs_frontend_event event)
+{
+    const auto callbacks = world().frontendCallbacks;
+    for (const auto &callback : callbacks)
+        callback.first(event, callback.second);
+}
+
+int enumerations()
+{
+    return world().enumerations;
+}
+
+int outstandingReferences()
+{
+    return world().references;
+}
+
+int connections()
+{
+    World &w = world();
+    size_t count = w.global.slots.size() + w.frontendCallbacks.size();
+    for (const auto &source : w.sources)
+        count += source->handler.slots.size();
+    return static_cast<int>(count);
+}
+
+} // namespace obs_stub
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+
+/*
+ * obs_stub.hpp
+ *
+ * Drives the in‑memory libobs stand‑in from the tests.  Every change
+ * raises the signal libobs would raise for it, on the calling thread,
+ * before the function returns.  Objects stay allocated until reset(),
+ * so pointers held by the code under test never dangle; a removed
+ * scene only stops resolving by name and through weak references.
+ */
+
+extern "C" {
+#include <obs.h>
+#include <obs-frontend-api.h>
+}
+
+namespace obs_stub {
+
+/** Drop every source, scene and connection. */
+void reset();
+
+/** Create a scene named name and return its source. */
+obs_source_t *createScene(const std::string &name);
+
+/** Create an image source and append it to the top of scene. */
+obs_sceneitem_t *addImage(obs_source_t *scene, const std::string &name, const std::string &file);
+
+/** Remove item from its scene (item_remove). */
+void removeItem(obs_sceneitem_t *item);
+
+/** Move item to the top of its scene (reorder). */
+void moveToTop(obs_sceneitem_t *item);
+
+/** Show or hide item (item_visible). */
+void setVisible(obs_sceneitem_t *item, bool visible);
+
+/** Change the "file" setting of the named source (source_update). */
+void setFile(const std::string &sourceName, const std::string &file);
+
+/** Rename a source (rename). */
+void rename(obs_source_t *source, const std::string &name);
+
+/** Remove and destroy a scene (remove, destroy). */
+void removeScene(obs_source_t *scene);
+
+/** Raise a frontend event. */
+void frontendEvent(enum obs_frontend_event event);
+
+/** Number of obs_scene_enum_items calls since the last reset. */
+int enumerations();
+
+/** Strong, weak and settings references not yet released. */
+int outstandingReferences();
+
+/** Signal and frontend callbacks still connected. */
+int connections();
+
+} // namespace obs_stub
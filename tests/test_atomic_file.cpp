@@ -0,0 +1,152 @@
+#include "atomic_file.hpp"
+
+#include <QDir>
+#include <QProcess>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QtTest>
+#include <cstdio>
+
+/*
+ * test_atomic_file.cpp
+ *
+ * writeFileAtomically must leave either the old file or the new one
+ * behind, whatever moment the writer dies at.  The kill test runs this
+ * executable again as a writer that replaces one file over and over,
+ * kills it at a random point and checks that the file holds exactly
+ * one complete version, never older than the one seen before.
+ */
+
+namespace {
+
+const int kPayloadSize = 2 * 1024 * 1024;
+const int kKillsPerLevel = 40;
+const int kMaxKillDelayUs = 60000;
+const int kMaxVersionsPerWriter = 100000;
+
+// Version line followed by bytes derived from the version, so any
+// version can be checked byte for byte without keeping it around
+QByteArray payload(quint32 version)
+{
+    QByteArray data = QByteArray("velutan-atomic-test ") + QByteArray::number(version) + '\n';
+    const qsizetype header = data.size();
+    data.resize(header + kPayloadSize);
+    QRandomGenerator generator(version);
+    generator.fillRange(reinterpret_cast<quint32 *>(data.data() + header), kPayloadSize / 4);
+    return data;
+}
+
+// Version held by a complete file, or -1 if it is not one
+qint64 versionOf(const QByteArray &data)
+{
+    const qsizetype newline = data.indexOf('\n');
+    if (newline < 0 || !data.startsWith("velutan-atomic-test "))
+        return -1;
+    bool ok = false;
+    const quint32 version = data.mid(20, newline - 20).toUInt(&ok);
+    if (!ok || data != payload(version))
+        return -1;
+    return version;
+}
+
+int runWriter(const char *path, const char *firstVersion, const char *durability)
+{
+    const QString target = QString::fromLocal8Bit(path);
+    const Durability level = durabilityFromName(QString::fromLatin1(durability));
+    const quint32 first = QByteArray(firstVersion).toUInt();
+    for (quint32 version = first; version < first + kMaxVersionsPerWriter; ++version) {
+        if (!writeFileAtomically(target, payload(version), level))
+            return 1;
+        if (version == first) {
+            std::puts("ready");
+            std::fflush(stdout);
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+class TestAtomicFile : public QObject
+{
+    Q_OBJECT
+private slots:
+    void replacesContents();
+    void failureLeavesNoFile();
+    void survivesKilledWriter_data();
+    void survivesKilledWriter();
+};
+
+void TestAtomicFile::replacesContents()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("library.json");
+
+    QVERIFY(writeFileAtomically(path, "first", Durability::Synced));
+    QVERIFY(writeFileAtomically(path, "second", Durability::Durable));
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), QByteArray("second"));
+
+    // No temporary files are left behind
+    QCOMPARE(QDir(dir.path()).entryList(QDir::Files | QDir::Hidden), QStringList{"library.json"});
+}
+
+void TestAtomicFile::failureLeavesNoFile()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("missing/library.json");
+
+    QVERIFY(!writeFileAtomically(path, "data", Durability::Atomic));
+    QVERIFY(!QFile::exists(path));
+}
+
+void TestAtomicFile::survivesKilledWriter_data()
+{
+    QTest::addColumn<QString>("durability");
+    QTest::newRow("atomic") << "atomic";
+    QTest::newRow("synced") << "synced";
+}
+
+void TestAtomicFile::survivesKilledWriter()
+{
+    QFETCH(QString, durability);
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath("library.json");
+
+    quint32 seen = 0;
+    for (int kill = 0; kill < kKillsPerLevel; ++kill) {
+        QProcess writer;
+        writer.start(QCoreApplication::applicationFilePath(),
+                     {"--writer", path, QString::number(seen + 1), durability});
+        QVERIFY(writer.waitForStarted());
+        QVERIFY2(writer.waitForReadyRead(30000), "writer did not finish its first write");
+
+        QThread::usleep(QRandomGenerator::global()->bounded(kMaxKillDelayUs));
+        writer.kill();
+        QVERIFY(writer.waitForFinished());
+
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        const qint64 version = versionOf(file.readAll());
+        QVERIFY2(version >= 0, qPrintable(QString("torn file after kill %1").arg(kill)));
+        QVERIFY2(quint32(version) > seen, "file went back to an older version");
+        seen = quint32(version);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc == 5 && qstrcmp(argv[1], "--writer") == 0)
+        return runWriter(argv[2], argv[3], argv[4]);
+
+    QCoreApplication app(argc, argv);
+    TestAtomicFile test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "test_atomic_file.moc"
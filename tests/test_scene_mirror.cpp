@@ -0,0 +1,187 @@
+#include "scene_mirror.hpp"
+#include "obs_stub.hpp"
+
+#include <QSignalSpy>
+#include <QtTest>
+
+/*
+ * test_scene_mirror.cpp
+ *
+ * SceneMirror against the libobs stub: the mirror must answer from its
+ * own state, follow every signal a scene or source can raise, and give
+ * back every reference and connection it takes.
+ */
+
+class TestSceneMirror : public QObject
+{
+    Q_OBJECT
+private slots:
+    void init();
+    void cleanup();
+
+    void mirrorsItemsInOrder();
+    void unknownSceneIsEmpty();
+    void visibilityNeedsNoEnumeration();
+    void structuralChangesResyncOnce();
+    void burstNotifiesOnce();
+    void externalFileChangeIsMirrored();
+    void noteFileIsMirrored();
+    void removedSceneIsDropped();
+    void renamedSceneAnswersToNewName();
+    void collectionChangeReleasesScenes();
+    void releasesEverythingOnDestruction();
+
+private:
+    SceneMirror *m_mirror = nullptr;
+    obs_source_t *m_scene = nullptr;
+    obs_sceneitem_t *m_background = nullptr;
+    obs_sceneitem_t *m_character = nullptr;
+};
+
+void TestSceneMirror::init()
+{
+    obs_stub::reset();
+    m_scene = obs_stub::createScene("Main");
+    m_background = obs_stub::addImage(m_scene, "Main_bg", "/assets/bg.png");
+    m_character = obs_stub::addImage(m_scene, "Main_char", "/assets/char.png");
+    m_mirror = new SceneMirror;
+}
+
+void TestSceneMirror::cleanup()
+{
+    delete m_mirror;
+    m_mirror = nullptr;
+    obs_stub::reset();
+}
+
+void TestSceneMirror::mirrorsItemsInOrder()
+{
+    const auto items = m_mirror->items("Main");
+    QCOMPARE(items.size(), 2);
+    QCOMPARE(items.value("Main_bg").order, 0);
+    QCOMPARE(items.value("Main_char").order, 1);
+    QCOMPARE(items.value("Main_bg").file, QString("/assets/bg.png"));
+    QVERIFY(items.value("Main_char").visible);
+}
+
+void TestSceneMirror::unknownSceneIsEmpty()
+{
+    QVERIFY(m_mirror->items("Missing").isEmpty());
+    QCOMPARE(obs_stub::outstandingReferences(), 0);
+}
+
+void TestSceneMirror::visibilityNeedsNoEnumeration()
+{
+    m_mirror->items("Main");
+    const int enumerations = obs_stub::enumerations();
+
+    obs_stub::setVisible(m_character, false);
+    QVERIFY(!m_mirror->items("Main").value("Main_char").visible);
+    QCOMPARE(obs_stub::enumerations(), enumerations);
+}
+
+void TestSceneMirror::structuralChangesResyncOnce()
+{
+    m_mirror->items("Main");
+    const int enumerations = obs_stub::enumerations();
+
+    obs_stub::addImage(m_scene, "Main_prop", "/assets/prop.png");
+    obs_stub::moveToTop(m_background);
+    obs_stub::removeItem(m_character);
+
+    const auto items = m_mirror->items("Main");
+    QCOMPARE(obs_stub::enumerations(), enumerations + 1);
+    QCOMPARE(items.size(), 2);
+    QVERIFY(!items.contains("Main_char"));
+    QCOMPARE(items.value("Main_prop").order, 0);
+    QCOMPARE(items.value("Main_bg").order, 1);
+
+    m_mirror->items("Main");
+    QCOMPARE(obs_stub::enumerations(), enumerations + 1);
+}
+
+void TestSceneMirror::burstNotifiesOnce()
+{
+    m_mirror->items("Main");
+    QSignalSpy spy(m_mirror, &SceneMirror::sceneChanged);
+
+    obs_stub::setVisible(m_background, false);
+    obs_stub::addImage(m_scene, "Main_prop", "/assets/prop.png");
+    obs_stub::setFile("Main_char", "/assets/char2.png");
+    QCOMPARE(spy.count(), 0);
+
+    QTRY_COMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).toString(), QString("Main"));
+}
+
+void TestSceneMirror::externalFileChangeIsMirrored()
+{
+    m_mirror->items("Main");
+    const int enumerations = obs_stub::enumerations();
+    QSignalSpy spy(m_mirror, &SceneMirror::sceneChanged);
+
+    obs_stub::setFile("Main_bg", "/assets/night.png");
+    QCOMPARE(m_mirror->items("Main").value("Main_bg").file, QString("/assets/night.png"));
+    QCOMPARE(obs_stub::enumerations(), enumerations);
+    QTRY_COMPARE(spy.count(), 1);
+
+    // Writing the same file again is not a change
+    obs_stub::setFile("Main_bg", "/assets/night.png");
+    QCoreApplication::processEvents();
+    QCOMPARE(spy.count(), 1);
+}
+
+void TestSceneMirror::noteFileIsMirrored()
+{
+    m_mirror->items("Main");
+    m_mirror->noteFile("Main_char", "/assets/wave.png");
+    QCOMPARE(m_mirror->items("Main").value("Main_char").file, QString("/assets/wave.png"));
+}
+
+void TestSceneMirror::removedSceneIsDropped()
+{
+    m_mirror->items("Main");
+    obs_stub::removeScene(m_scene);
+
+    QVERIFY(m_mirror->items("Main").isEmpty());
+    QCOMPARE(obs_stub::outstandingReferences(), 0);
+}
+
+void TestSceneMirror::renamedSceneAnswersToNewName()
+{
+    m_mirror->items("Main");
+    obs_stub::rename(m_scene, "Stage");
+
+    QVERIFY(m_mirror->items("Main").isEmpty());
+    QCOMPARE(m_mirror->items("Stage").size(), 2);
+
+    // Signals reach the entry under the new name
+    obs_stub::setVisible(m_background, false);
+    QVERIFY(!m_mirror->items("Stage").value("Main_bg").visible);
+}
+
+void TestSceneMirror::collectionChangeReleasesScenes()
+{
+    m_mirror->items("Main");
+    const int enumerations = obs_stub::enumerations();
+
+    obs_stub::frontendEvent(OBS_FRONTEND_EVENT_SCENE_COLLECTION_CHANGING);
+    QCOMPARE(obs_stub::outstandingReferences(), 0);
+
+    QCOMPARE(m_mirror->items("Main").size(), 2);
+    QCOMPARE(obs_stub::enumerations(), enumerations + 1);
+}
+
+void TestSceneMirror::releasesEverythingOnDestruction()
+{
+    m_mirror->items("Main");
+    QVERIFY(obs_stub::connections() > 0);
+
+    delete m_mirror;
+    m_mirror = nullptr;
+    QCOMPARE(obs_stub::outstandingReferences(), 0);
+    QCOMPARE(obs_stub::connections(), 0);
+}
+
+QTEST_GUILESS_MAIN(TestSceneMirror)
+#include "test_scene_mirror.moc"
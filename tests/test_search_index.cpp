@@ -0,0 +1,98 @@
+#include "search_index.hpp"
+
+#include <QtTest>
+#include <algorithm>
+#include <functional>
+
+/*
+ * test_search_index.cpp
+ *
+ * SearchIndex must return exactly the rows AssetLibrary::search finds,
+ * including after rows have been removed one at a time or in a batch.
+ */
+
+namespace {
+
+const char *const kWords[] = {"forest", "night", "castle", "rain", "tavern", "ruins", "snow"};
+
+Library makeLibrary(int count)
+{
+    Library lib;
+    for (int i = 0; i < count; ++i) {
+        Asset asset;
+        asset.id = QString::number(i);
+        asset.name = QString("%1 %2").arg(QLatin1String(kWords[i % 7])).arg(i);
+        asset.theme = QLatin1String(kWords[(i / 7) % 7]);
+        asset.tags << QLatin1String(kWords[(i * 3) % 7]);
+        AssetLibrary::internAsset(lib, asset);
+        lib.backgrounds.push_back(asset);
+    }
+    return lib;
+}
+
+QVector<QString> idsOf(const QVector<Asset> &assets)
+{
+    QVector<QString> ids;
+    for (const Asset &asset : assets)
+        ids.push_back(asset.id);
+    return ids;
+}
+
+} // namespace
+
+class TestSearchIndex : public QObject
+{
+    Q_OBJECT
+private slots:
+    void matchesLinearSearch_data();
+    void matchesLinearSearch();
+};
+
+void TestSearchIndex::matchesLinearSearch_data()
+{
+    QTest::addColumn<QVector<int>>("removed");
+    QTest::addColumn<bool>("batch");
+    QTest::newRow("nothing removed") << QVector<int>{} << true;
+    QTest::newRow("one row") << QVector<int>{5} << false;
+    QTest::newRow("one by one") << QVector<int>{40, 3, 17, 0, 90} << false;
+    QTest::newRow("batch") << QVector<int>{40, 3, 17, 0, 99, 17, 500} << true;
+    QTest::newRow("batch of neighbours") << QVector<int>{10, 11, 12, 13, 14} << true;
+}
+
+void TestSearchIndex::matchesLinearSearch()
+{
+    QFETCH(QVector<int>, removed);
+    QFETCH(bool, batch);
+
+    Library lib = makeLibrary(100);
+    SearchIndex index;
+    index.build(lib.backgrounds, lib.strings);
+
+    if (batch) {
+        index.remove(removed);
+        QVector<int> rows = removed;
+        std::sort(rows.begin(), rows.end(), std::greater<int>());
+        rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+        for (int row : rows) {
+            if (row < lib.backgrounds.size())
+                lib.backgrounds.removeAt(row);
+        }
+    } else {
+        // Each row as numbered after the previous removals
+        for (int row : removed) {
+            index.remove(row);
+            lib.backgrounds.removeAt(row);
+        }
+    }
+    QCOMPARE(index.size(), int(lib.backgrounds.size()));
+
+    for (const char *query : {"", "fo", "forest", "rain", "night 1", "ruins 9", "zzz"}) {
+        QVector<Asset> indexed;
+        for (int row : index.search(lib.backgrounds, lib.strings, QString::fromLatin1(query)))
+            indexed.push_back(lib.backgrounds.at(row));
+        QCOMPARE(idsOf(indexed), idsOf(AssetLibrary::search(lib.backgrounds, QString::fromLatin1(query))));
+    }
+}
+
+QTEST_GUILESS_MAIN(TestSearchIndex)
+#include "test_search_index.moc"